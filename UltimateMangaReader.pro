@@ -19,7 +19,7 @@ QT    += core gui widgets network svg
 CONFIG += c++17
 QMAKE_LFLAGS += -rdynamic
 
-LIBS +=  -lturbojpeg -lpng
+LIBS +=  -lturbojpeg -ljpeg -lpng -lz
 
 TARGET = UltimateMangaReader
 
@@ -49,13 +49,24 @@ FORMS += \
 
 HEADERS += \
     aboutinfo.h \
+    adaptiveparallelism.h \
+    boundedqueue.h \
+    bufferednetworkreply.h \
+    cancellationtoken.h \
+    contentdecoder.h \
+    customnetworkaccessmanager.h \
     dither.h \
     downloadbufferjob.h \
     enums.h \
     greyscaleimage.h \
+    htmlstreamscanner.h \
+    httpvalidationcache.h \
+    imageblobstore.h \
     imageprocessingnative.h \
+    imageprocessingpipeline.h \
     imageprocessingqt.h \
     imagerotate.h \
+    jobfuture.h \
     mangachaptercollection.h \
     mangachapterdownloadmanager.h \
     mangacontroller.h \
@@ -66,16 +77,26 @@ HEADERS += \
     mangasources/mangaplus.h \
     mangasources/mangatown.h \
     mangasources/updateprogresstoken.h \
+    networkfixtures.h \
     networkmanager.h \
+    networkmetrics.h \
+    networkshaper.h \
+    radioburstscheduler.h \
+    ratelimiter.h \
     readingprogress.h \
+    redirectcache.h \
+    requesthedging.h \
+    retrypolicy.h \
     sizes.h \
     stacktrace.h \
     staticsettings.h \
+    streamingimagedecoder.h \
     suspendmanager.h \
     thirdparty/picoproto.h \
     thirdparty/rapidjson.h \
     thirdparty/result.h \
     thirdparty/simdimageresize.h \
+    tlssessioncache.h \
     ultimatemangareadercore.h \
     widgets/aboutdialog.h \
     widgets/batteryicon.h \
@@ -120,12 +141,22 @@ HEADERS += \
     widgets/wifidialog.h
 
 SOURCES += \
+    adaptiveparallelism.cpp \
+    bufferednetworkreply.cpp \
+    cancellationtoken.cpp \
+    contentdecoder.cpp \
+    customnetworkaccessmanager.cpp \
     dither.cpp \
     downloadbufferjob.cpp \
     greyscaleimage.cpp \
+    htmlstreamscanner.cpp \
+    httpvalidationcache.cpp \
+    imageblobstore.cpp \
     imageprocessingnative.cpp \
+    imageprocessingpipeline.cpp \
     imageprocessingqt.cpp \
     imagerotate.cpp \
+    jobfuture.cpp \
     mangachaptercollection.cpp \
     mangachapterdownloadmanager.cpp \
     mangacontroller.cpp \
@@ -137,11 +168,21 @@ SOURCES += \
     mangasources/mangaplus.cpp \
     mangasources/mangatown.cpp \
     mangasources/updateprogresstoken.cpp \
+    networkfixtures.cpp \
     networkmanager.cpp \
+    networkmetrics.cpp \
+    networkshaper.cpp \
+    radioburstscheduler.cpp \
+    ratelimiter.cpp \
     readingprogress.cpp \
+    redirectcache.cpp \
+    requesthedging.cpp \
+    retrypolicy.cpp \
+    streamingimagedecoder.cpp \
     suspendmanager.cpp \
     thirdparty/picoproto.cc \
     thirdparty/simdimageresize.cpp \
+    tlssessioncache.cpp \
     ultimatemangareadercore.cpp \
     widgets/aboutdialog.cpp \
     widgets/batteryicon.cpp \
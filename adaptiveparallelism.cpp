@@ -0,0 +1,159 @@
+#include "adaptiveparallelism.h"
+
+#include "staticsettings.h"
+
+AdaptiveParallelism::AdaptiveParallelism() : hosts(), dirty(false)
+{
+    deserialize();
+}
+
+AdaptiveParallelism::~AdaptiveParallelism()
+{
+    serialize();
+}
+
+HostParallelism &AdaptiveParallelism::host(const QString &host, int initial)
+{
+    if (!hosts.contains(host))
+        hosts[host].limit = qBound(minLimit, initial, maxLimit);
+
+    return hosts[host];
+}
+
+int AdaptiveParallelism::limit(const QString &host, int initial)
+{
+    return this->host(host, initial).limit;
+}
+
+int AdaptiveParallelism::running(const QString &host) const
+{
+    return hosts.value(host).running;
+}
+
+void AdaptiveParallelism::downloadStarted(const QString &hostname)
+{
+    auto &h = host(hostname, minLimit);
+
+    h.running++;
+
+    if (!h.roundTimer.isValid())
+        h.roundTimer.start();
+}
+
+void AdaptiveParallelism::downloadSucceeded(const QString &hostname, qint64 bytes, qint64 latencyMs)
+{
+    auto &h = host(hostname, minLimit);
+
+    if (!h.roundTimer.isValid())
+        h.roundTimer.start();
+
+    h.roundBytes += bytes;
+    h.roundLatency += latencyMs;
+    h.roundCompleted++;
+
+    if (h.roundCompleted >= h.limit)
+        evaluateRound(hostname, h);
+}
+
+void AdaptiveParallelism::downloadCongested(const QString &hostname)
+{
+    auto &h = host(hostname, minLimit);
+
+    // multiplicative decrease, the next round measures the new level from scratch
+    h.lastThroughput = 0;
+    h.lastLatency = 0;
+    h.stableRounds = 0;
+    h.roundTimer.invalidate();
+    h.roundBytes = 0;
+    h.roundLatency = 0;
+    h.roundCompleted = 0;
+
+    setLimit(hostname, h, h.limit / 2);
+}
+
+void AdaptiveParallelism::downloadFinished(const QString &hostname)
+{
+    auto &h = host(hostname, minLimit);
+
+    h.running = qMax(0, h.running - 1);
+}
+
+void AdaptiveParallelism::evaluateRound(const QString &hostname, HostParallelism &h)
+{
+    double throughput = (double)h.roundBytes / qMax<qint64>(1, h.roundTimer.elapsed());
+    double latency = (double)h.roundLatency / h.roundCompleted;
+
+    // the first round (after a start or a decrease) only sets the level the next one is compared against
+    int newLimit = h.limit;
+    if (h.lastThroughput > 0)
+    {
+        bool improved = throughput > h.lastThroughput * 1.05 && latency < h.lastLatency * 1.5;
+        bool degraded = throughput < h.lastThroughput * 0.8;
+
+        if (improved)
+            newLimit++;
+        else if (degraded)
+            newLimit--;
+        else if (++h.stableRounds >= probeAfterStableRounds)
+            newLimit++;  // probe again once in a while, conditions change
+    }
+
+    if (newLimit != h.limit)
+        h.stableRounds = 0;
+
+    h.lastThroughput = throughput;
+    h.lastLatency = latency;
+    h.roundTimer.invalidate();
+    h.roundBytes = 0;
+    h.roundLatency = 0;
+    h.roundCompleted = 0;
+
+    setLimit(hostname, h, newLimit);
+}
+
+void AdaptiveParallelism::setLimit(const QString &hostname, HostParallelism &h, int limit)
+{
+    limit = qBound(minLimit, limit, maxLimit);
+    if (limit == h.limit)
+        return;
+
+    qDebug() << "Parallel downloads for" << hostname << h.limit << "->" << limit;
+
+    h.limit = limit;
+    dirty = true;
+}
+
+void AdaptiveParallelism::deserialize()
+{
+    QFile file(CONF.cacheDir + "parallelism.dat");
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    QMap<QString, int> limits;
+    QDataStream in(&file);
+    in >> limits;
+    file.close();
+
+    for (auto it = limits.begin(); it != limits.end(); ++it)
+        hosts[it.key()].limit = qBound(minLimit, it.value(), maxLimit);
+}
+
+void AdaptiveParallelism::serialize()
+{
+    if (!dirty)
+        return;
+
+    QFile file(CONF.cacheDir + "parallelism.dat");
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+
+    QMap<QString, int> limits;
+    for (auto it = hosts.begin(); it != hosts.end(); ++it)
+        limits.insert(it.key(), it.value().limit);
+
+    QDataStream out(&file);
+    out << limits;
+    file.close();
+
+    dirty = false;
+}
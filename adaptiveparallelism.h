@@ -0,0 +1,63 @@
+#ifndef ADAPTIVEPARALLELISM_H
+#define ADAPTIVEPARALLELISM_H
+
+#include <QElapsedTimer>
+#include <QMap>
+#include <QString>
+
+struct HostParallelism
+{
+    int limit = 1;
+    int running = 0;  // downloads of all queues
+
+    // results of the last completed measurement round
+    double lastThroughput = 0;
+    double lastLatency = 0;
+    int stableRounds = 0;
+
+    // current measurement round
+    QElapsedTimer roundTimer;
+    qint64 roundBytes = 0;
+    qint64 roundLatency = 0;
+    int roundCompleted = 0;
+};
+
+// AIMD controller for the number of parallel downloads per host.
+// A measurement round lasts as many downloads as the current limit. The limit is raised by one
+// while the aggregate throughput of a round improves without the latency blowing up and is halved
+// on congestion signals (429/503, timeouts, connection resets).
+// The running downloads are counted over all queues, so the limit holds for the host as a whole.
+// The chosen limits are stored in the cache dir and reused in the next session.
+class AdaptiveParallelism
+{
+public:
+    AdaptiveParallelism();
+    ~AdaptiveParallelism();
+
+    int limit(const QString &host, int initial);
+    int running(const QString &host) const;
+
+    void downloadStarted(const QString &host);
+    void downloadSucceeded(const QString &host, qint64 bytes, qint64 latencyMs);
+    void downloadCongested(const QString &host);
+    // every started download ends with this, whatever its outcome
+    void downloadFinished(const QString &host);
+
+    void serialize();
+
+private:
+    const int minLimit = 1;
+    const int maxLimit = 16;
+    const int probeAfterStableRounds = 8;
+
+    QMap<QString, HostParallelism> hosts;
+    bool dirty;
+
+    HostParallelism &host(const QString &host, int initial);
+    void evaluateRound(const QString &hostname, HostParallelism &host);
+    void setLimit(const QString &hostname, HostParallelism &host, int limit);
+
+    void deserialize();
+};
+
+#endif  // ADAPTIVEPARALLELISM_H
@@ -0,0 +1,99 @@
+#ifndef BOUNDEDQUEUE_H
+#define BOUNDEDQUEUE_H
+
+#include <QMutex>
+#include <QQueue>
+#include <QWaitCondition>
+
+// thread safe fifo queue, push blocks while the queue is full and pop blocks while it is empty
+// a capacity <= 0 means the queue is unbounded
+template <typename T>
+class BoundedQueue
+{
+public:
+    explicit BoundedQueue(int capacity) : capacity(capacity), closed(false) {}
+
+    bool push(T &&item)
+    {
+        QMutexLocker locker(&mutex);
+
+        while (!closed && capacity > 0 && queue.count() >= capacity)
+            notFull.wait(&mutex);
+
+        if (closed)
+            return false;
+
+        queue.enqueue(std::move(item));
+        notEmpty.wakeOne();
+
+        return true;
+    }
+
+    bool pop(T &item)
+    {
+        QMutexLocker locker(&mutex);
+
+        while (!closed && queue.isEmpty())
+            notEmpty.wait(&mutex);
+
+        if (queue.isEmpty())
+            return false;
+
+        item = queue.dequeue();
+        notFull.wakeOne();
+
+        return true;
+    }
+
+    void close()
+    {
+        QMutexLocker locker(&mutex);
+
+        closed = true;
+        notEmpty.wakeAll();
+        notFull.wakeAll();
+    }
+
+    // removes all matching items, returns how many were removed
+    template <typename Predicate>
+    int removeIf(Predicate predicate)
+    {
+        QMutexLocker locker(&mutex);
+
+        int removed = 0;
+        for (auto it = queue.begin(); it != queue.end();)
+        {
+            if (predicate(*it))
+            {
+                it = queue.erase(it);
+                removed++;
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        if (removed > 0)
+            notFull.wakeAll();
+
+        return removed;
+    }
+
+    int count() const
+    {
+        QMutexLocker locker(&mutex);
+
+        return queue.count();
+    }
+
+private:
+    mutable QMutex mutex;
+    QWaitCondition notEmpty;
+    QWaitCondition notFull;
+    QQueue<T> queue;
+    int capacity;
+    bool closed;
+};
+
+#endif  // BOUNDEDQUEUE_H
@@ -0,0 +1,124 @@
+#include "bufferednetworkreply.h"
+
+#include <limits>
+
+BufferedNetworkReply::BufferedNetworkReply(QNetworkAccessManager::Operation op,
+                                           const QNetworkRequest &request, QObject *parent)
+    : QNetworkReply(parent), buffer(), received(0)
+{
+    setOperation(op);
+    setRequest(request);
+    setUrl(request.url());
+
+    open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+}
+
+void BufferedNetworkReply::setResponse(int status, const QByteArray &reason,
+                                       const QList<RawHeaderPair> &headers)
+{
+    if (status > 0)
+    {
+        setAttribute(QNetworkRequest::HttpStatusCodeAttribute, status);
+        setAttribute(QNetworkRequest::HttpReasonPhraseAttribute, reason);
+    }
+
+    for (const auto &header : headers)
+        setRawHeader(header.first, header.second);
+
+    if (status >= 300 && status < 400 && hasRawHeader("Location"))
+        setAttribute(QNetworkRequest::RedirectionTargetAttribute, QUrl(QString(rawHeader("Location"))));
+
+    emit metaDataChanged();
+}
+
+void BufferedNetworkReply::copyResponse(QNetworkReply *reply)
+{
+    for (auto attribute : {QNetworkRequest::HttpStatusCodeAttribute, QNetworkRequest::HttpReasonPhraseAttribute,
+                           QNetworkRequest::RedirectionTargetAttribute,
+                           QNetworkRequest::Http2WasUsedAttribute, QNetworkRequest::SourceIsFromCacheAttribute})
+        setAttribute(attribute, reply->attribute(attribute));
+
+    for (const auto &header : reply->rawHeaderPairs())
+        setRawHeader(header.first, header.second);
+
+    emit metaDataChanged();
+}
+
+void BufferedNetworkReply::appendData(const QByteArray &data)
+{
+    if (isFinished() || data.isEmpty())
+        return;
+
+    buffer.append(data);
+    received += data.size();
+
+    emit downloadProgress(received, header(QNetworkRequest::ContentLengthHeader).toLongLong());
+    emit readyRead();
+}
+
+void BufferedNetworkReply::finishReply(QNetworkReply::NetworkError error, const QString &errorString)
+{
+    if (isFinished())
+        return;
+
+    if (error != QNetworkReply::NoError)
+    {
+        setError(error, errorString);
+        emit errorOccurred(error);
+    }
+
+    setFinished(true);
+    emit finished();
+}
+
+qint64 BufferedNetworkReply::bufferSpace() const
+{
+    if (readBufferSize() <= 0)
+        return std::numeric_limits<qint64>::max();
+
+    return qMax<qint64>(0, readBufferSize() - buffer.size());
+}
+
+void BufferedNetworkReply::abort()
+{
+    if (isFinished())
+        return;
+
+    emit abortRequested();
+    finishReply(QNetworkReply::OperationCanceledError, "Operation canceled");
+}
+
+void BufferedNetworkReply::ignoreSslErrors()
+{
+    emit ignoreSslErrorsRequested();
+}
+
+void BufferedNetworkReply::setReadBufferSize(qint64 size)
+{
+    QNetworkReply::setReadBufferSize(size);
+    emit readBufferSizeChanged(size);
+}
+
+bool BufferedNetworkReply::isSequential() const
+{
+    return true;
+}
+
+qint64 BufferedNetworkReply::bytesAvailable() const
+{
+    return buffer.size() + QNetworkReply::bytesAvailable();
+}
+
+qint64 BufferedNetworkReply::readData(char *data, qint64 maxSize)
+{
+    if (buffer.isEmpty())
+        return isFinished() ? -1 : 0;
+
+    qint64 size = qMin<qint64>(maxSize, buffer.size());
+    memcpy(data, buffer.constData(), size);
+    buffer.remove(0, size);
+
+    emit dataConsumed();
+
+    return size;
+}
@@ -0,0 +1,47 @@
+#ifndef BUFFEREDNETWORKREPLY_H
+#define BUFFEREDNETWORKREPLY_H
+
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+
+// Reply whose response is pushed in by code instead of coming from a socket.
+// Used to serve recorded responses and to put a layer between the jobs and the real replies.
+class BufferedNetworkReply : public QNetworkReply
+{
+    Q_OBJECT
+
+public:
+    BufferedNetworkReply(QNetworkAccessManager::Operation op, const QNetworkRequest &request,
+                         QObject *parent = nullptr);
+
+    void setResponse(int status, const QByteArray &reason, const QList<RawHeaderPair> &headers);
+    void copyResponse(QNetworkReply *reply);
+    void appendData(const QByteArray &data);
+    void finishReply(QNetworkReply::NetworkError error = QNetworkReply::NoError,
+                     const QString &errorString = "");
+
+    // bytes that can be appended before the read buffer size set by the reader is reached,
+    // a layer in front of a real reply only reads that much from it to keep its backpressure
+    qint64 bufferSpace() const;
+
+    void abort() override;
+    void ignoreSslErrors() override;
+    void setReadBufferSize(qint64 size) override;
+    bool isSequential() const override;
+    qint64 bytesAvailable() const override;
+
+signals:
+    void abortRequested();
+    void ignoreSslErrorsRequested();
+    void readBufferSizeChanged(qint64 size);
+    void dataConsumed();
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override;
+
+private:
+    QByteArray buffer;
+    qint64 received;
+};
+
+#endif  // BUFFEREDNETWORKREPLY_H
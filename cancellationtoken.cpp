@@ -0,0 +1,19 @@
+#include "cancellationtoken.h"
+
+CancellationToken::CancellationToken(QObject *parent) : QObject(parent), cancelledFlag(0) {}
+
+void CancellationToken::cancel()
+{
+    if (cancelledFlag.testAndSetOrdered(0, 1))
+        emit cancelled();
+}
+
+void CancellationToken::reset()
+{
+    cancelledFlag.storeRelease(0);
+}
+
+bool CancellationToken::isCancelled() const
+{
+    return cancelledFlag.loadAcquire() != 0;
+}
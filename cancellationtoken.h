@@ -0,0 +1,27 @@
+#ifndef CANCELLATIONTOKEN_H
+#define CANCELLATIONTOKEN_H
+
+#include <QAtomicInt>
+#include <QObject>
+
+// Thread safe cancellation flag.
+// cancel() may be called from any thread, cancelled() is emitted once per cancellation.
+class CancellationToken : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit CancellationToken(QObject *parent = nullptr);
+
+    void cancel();
+    void reset();
+    bool isCancelled() const;
+
+signals:
+    void cancelled();
+
+private:
+    QAtomicInt cancelledFlag;
+};
+
+#endif  // CANCELLATIONTOKEN_H
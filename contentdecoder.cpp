@@ -0,0 +1,120 @@
+#include "contentdecoder.h"
+
+#include <zlib.h>
+
+ContentDecoder::ContentDecoder(const QByteArray &contentEncoding)
+    : format(Identity), stream(nullptr), initialized(false), streamEnd(false), error()
+{
+    auto encoding = contentEncoding.trimmed().toLower();
+
+    if (encoding == "gzip" || encoding == "x-gzip")
+        format = Gzip;
+    else if (encoding == "deflate")
+        format = Deflate;
+}
+
+ContentDecoder::~ContentDecoder()
+{
+    if (initialized)
+        inflateEnd(stream);
+
+    delete stream;
+}
+
+bool ContentDecoder::isCompressed() const
+{
+    return format != Identity;
+}
+
+QString ContentDecoder::errorString() const
+{
+    return error;
+}
+
+bool ContentDecoder::init(const QByteArray &data)
+{
+    stream = new z_stream();
+
+    int windowBits = 15 + 16;  // gzip header
+    if (format == Deflate)
+    {
+        // a zlib header is a multiple of 31 with compression method 8, anything else is raw deflate
+        bool zlibHeader = data.size() < 2 || ((quint8(data[0]) & 0x0f) == 8 &&
+                                              ((quint8(data[0]) << 8) | quint8(data[1])) % 31 == 0);
+        windowBits = zlibHeader ? 15 : -15;
+    }
+
+    if (inflateInit2(stream, windowBits) != Z_OK)
+    {
+        error = "Couldn't initialize decompression.";
+        return false;
+    }
+
+    initialized = true;
+
+    return true;
+}
+
+bool ContentDecoder::decode(const QByteArray &data, QByteArray &out)
+{
+    if (format == Identity)
+    {
+        out.append(data);
+        return true;
+    }
+
+    if (!error.isEmpty())
+        return false;
+
+    // anything after the end of the stream is ignored
+    if (data.isEmpty() || streamEnd)
+        return true;
+
+    if (!initialized && !init(data))
+        return false;
+
+    char chunk[16 * 1024];
+
+    stream->next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.constData()));
+    stream->avail_in = data.size();
+
+    do
+    {
+        stream->next_out = reinterpret_cast<Bytef *>(chunk);
+        stream->avail_out = sizeof(chunk);
+
+        int ret = inflate(stream, Z_NO_FLUSH);
+        if (ret == Z_NEED_DICT || ret == Z_DATA_ERROR || ret == Z_MEM_ERROR)
+        {
+            error = QString("Invalid compressed data: ") + (stream->msg ? stream->msg : "");
+            return false;
+        }
+
+        out.append(chunk, sizeof(chunk) - stream->avail_out);
+
+        if (ret == Z_STREAM_END)
+        {
+            streamEnd = true;
+            break;
+        }
+
+        if (ret == Z_BUF_ERROR)
+            break;
+    } while (stream->avail_in > 0 || stream->avail_out == 0);
+
+    return true;
+}
+
+bool ContentDecoder::finish()
+{
+    if (!error.isEmpty())
+        return false;
+
+    if (initialized && !streamEnd)
+    {
+        error = "Compressed data ended unexpectedly.";
+        return false;
+    }
+
+    return true;
+}
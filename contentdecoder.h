@@ -0,0 +1,43 @@
+#ifndef CONTENTDECODER_H
+#define CONTENTDECODER_H
+
+#include <QByteArray>
+#include <QString>
+
+struct z_stream_s;
+
+// Incremental zlib decoder for the Content-Encoding of a response.
+// Handles gzip and deflate (zlib wrapped, or raw as sent by some servers),
+// any other encoding is passed through unchanged.
+class ContentDecoder
+{
+public:
+    explicit ContentDecoder(const QByteArray &contentEncoding);
+    ~ContentDecoder();
+
+    bool isCompressed() const;
+
+    // appends the decoded part of data to out
+    bool decode(const QByteArray &data, QByteArray &out);
+    bool finish();
+
+    QString errorString() const;
+
+private:
+    enum Format
+    {
+        Identity,
+        Gzip,
+        Deflate
+    };
+
+    Format format;
+    z_stream_s *stream;
+    bool initialized;
+    bool streamEnd;
+    QString error;
+
+    bool init(const QByteArray &data);
+};
+
+#endif  // CONTENTDECODER_H
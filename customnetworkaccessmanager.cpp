@@ -0,0 +1,164 @@
+#include "customnetworkaccessmanager.h"
+
+// the domain itself and its subdomains, a domain with a leading dot only matches the subdomains
+static bool matchesDomain(const QString &host, const QString &domain)
+{
+    if (domain.startsWith('.'))
+        return host.endsWith(domain);
+
+    return host == domain || host.endsWith("." + domain);
+}
+
+CustomNetworkAccessManager::CustomNetworkAccessManager(QObject *parent)
+    : QNetworkAccessManager(parent),
+      mutex(),
+      policies(),
+      stats(),
+      networkFixtures(),
+      networkShaper(),
+      tlsSessions()
+{
+}
+
+NetworkFixtures *CustomNetworkAccessManager::fixtures()
+{
+    return &networkFixtures;
+}
+
+NetworkShaper *CustomNetworkAccessManager::shaper()
+{
+    return &networkShaper;
+}
+
+TlsSessionCache *CustomNetworkAccessManager::sessionCache()
+{
+    return &tlsSessions;
+}
+
+void CustomNetworkAccessManager::warmupConnections(int maxHosts)
+{
+    if (networkFixtures.mode() == NetworkFixtures::Replay)
+        return;
+
+    // the pre-connections go through createRequest() and get the host policy and session ticket
+    for (const auto &host : tlsSessions.recentHosts(maxHosts))
+        connectToHostEncrypted(host, tlsSessions.port(host));
+}
+
+void CustomNetworkAccessManager::setHostPolicy(const QString &domain, const HostConnectionPolicy &policy)
+{
+    QMutexLocker locker(&mutex);
+
+    for (auto &p : policies)
+    {
+        if (p.first == domain)
+        {
+            p.second = policy;
+            return;
+        }
+    }
+
+    policies.append({domain, policy});
+}
+
+HostConnectionPolicy CustomNetworkAccessManager::hostPolicy(const QString &host) const
+{
+    QMutexLocker locker(&mutex);
+
+    for (const auto &p : qAsConst(policies))
+        if (matchesDomain(host, p.first))
+            return p.second;
+
+    return HostConnectionPolicy();
+}
+
+HostConnectionStats CustomNetworkAccessManager::hostStats(const QString &host) const
+{
+    QMutexLocker locker(&mutex);
+
+    return stats.value(host);
+}
+
+QNetworkReply *CustomNetworkAccessManager::createRequest(Operation op, const QNetworkRequest &originalReq,
+                                                         QIODevice *outgoingData)
+{
+    auto host = originalReq.url().host();
+    auto policy = hostPolicy(host);
+
+    QNetworkRequest request(originalReq);
+    request.setAttribute(QNetworkRequest::Http2AllowedAttribute, policy.http2);
+    if (!policy.keepAlive)
+        request.setRawHeader("Connection", "close");
+
+    auto scheme = request.url().scheme();
+    if (scheme == "https" || scheme == "preconnect-https")
+    {
+        auto sslConfig = request.sslConfiguration();
+        tlsSessions.prepareConfiguration(host, sslConfig);
+        request.setSslConfiguration(sslConfig);
+    }
+
+    // connectToHost*() pre-connections, nothing to count, record or shape
+    if (scheme.startsWith("preconnect"))
+        return QNetworkAccessManager::createRequest(op, request, outgoingData);
+
+    // the fixtures are keyed by the request body as well
+    QByteArray body;
+    if (networkFixtures.mode() != NetworkFixtures::Off && outgoingData)
+    {
+        body = outgoingData->readAll();
+        auto buffer = new QBuffer(this);
+        buffer->setData(body);
+        buffer->open(QIODevice::ReadOnly);
+        outgoingData = buffer;
+    }
+
+    if (networkFixtures.mode() == NetworkFixtures::Replay)
+    {
+        if (outgoingData)
+            outgoingData->deleteLater();
+
+        auto reply = networkFixtures.replay(op, request, body, this);
+        return networkShaper.isEnabled() ? networkShaper.shape(reply, op, request, this) : reply;
+    }
+
+    auto reply = QNetworkAccessManager::createRequest(op, request, outgoingData);
+
+    if (outgoingData && outgoingData->parent() == this)
+        outgoingData->setParent(reply);
+
+    {
+        QMutexLocker locker(&mutex);
+        stats[host].requests++;
+    }
+
+    // only emitted when no idle connection to the host could be reused,
+    // before Qt 6.3 only new TLS handshakes tell so and plain http connections aren't counted
+#if QT_VERSION >= QT_VERSION_CHECK(6, 3, 0)
+    QObject::connect(reply, &QNetworkReply::socketStartedConnecting, this, [this, host]() {
+#else
+    QObject::connect(reply, &QNetworkReply::encrypted, this, [this, host]() {
+#endif
+        QMutexLocker locker(&mutex);
+        stats[host].connectionsOpened++;
+    });
+    QObject::connect(reply, &QNetworkReply::finished, this, [this, host, reply]() {
+        if (reply->attribute(QNetworkRequest::Http2WasUsedAttribute).toBool())
+        {
+            QMutexLocker locker(&mutex);
+            stats[host].http2Responses++;
+        }
+
+        // TLS 1.3 tickets arrive after the handshake, so they are picked up at the end
+        if (reply->url().scheme() == "https")
+            tlsSessions.store(reply->url().host(), reply->url().port(443), reply->sslConfiguration());
+    });
+
+    if (networkFixtures.mode() == NetworkFixtures::Record)
+        reply = networkFixtures.record(reply, op, request, body, this);
+
+    if (networkShaper.isEnabled())
+        reply = networkShaper.shape(reply, op, request, this);
+
+    return reply;
+}
@@ -0,0 +1,69 @@
+#ifndef CUSTOMNETWORKACCESSMANAGER_H
+#define CUSTOMNETWORKACCESSMANAGER_H
+
+#include <QtNetwork>
+
+#include "networkfixtures.h"
+#include "networkshaper.h"
+#include "tlssessioncache.h"
+
+struct HostConnectionPolicy
+{
+    HostConnectionPolicy(bool http2 = false, int maxConnections = 0, bool keepAlive = true)
+        : http2(http2), maxConnections(maxConnections), keepAlive(keepAlive)
+    {
+    }
+
+    bool http2;
+    int maxConnections;  // <= 0 means no cap besides the adaptive parallelism
+    bool keepAlive;
+};
+
+struct HostConnectionStats
+{
+    int requests = 0;
+    int connectionsOpened = 0;
+    int http2Responses = 0;
+
+    double reuseRatio() const
+    {
+        return requests > 0 ? qMax(0.0, 1.0 - (double)connectionsOpened / requests) : 0.0;
+    }
+};
+
+// QNetworkAccessManager that applies a connection policy per host to every request
+// and keeps statistics about how many connections had to be opened.
+// TLS sessions are resumed from the TlsSessionCache, warmupConnections() pre-connects
+// to the most recently used hosts (DNS, TCP and TLS) before the first request is made.
+// Lives on the network thread, the policies and statistics can be used from any thread.
+class CustomNetworkAccessManager : public QNetworkAccessManager
+{
+    Q_OBJECT
+
+public:
+    explicit CustomNetworkAccessManager(QObject *parent = nullptr);
+
+    void setHostPolicy(const QString &domain, const HostConnectionPolicy &policy);
+    HostConnectionPolicy hostPolicy(const QString &host) const;
+    HostConnectionStats hostStats(const QString &host) const;
+
+    NetworkFixtures *fixtures();
+    NetworkShaper *shaper();
+    TlsSessionCache *sessionCache();
+
+    void warmupConnections(int maxHosts = 4);
+
+protected:
+    QNetworkReply *createRequest(Operation op, const QNetworkRequest &originalReq,
+                                 QIODevice *outgoingData = nullptr) override;
+
+private:
+    mutable QMutex mutex;
+    QList<QPair<QString, HostConnectionPolicy>> policies;
+    QMap<QString, HostConnectionStats> stats;
+    NetworkFixtures networkFixtures;
+    NetworkShaper networkShaper;
+    TlsSessionCache tlsSessions;
+};
+
+#endif  // CUSTOMNETWORKACCESSMANAGER_H
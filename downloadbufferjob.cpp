@@ -5,19 +5,49 @@
 DownloadBufferJob::DownloadBufferJob(QNetworkAccessManager *networkManager, const QString &url, int timeout,
                                      const QByteArray &postdata,
                                      const QList<std::tuple<const char *, const char *> > &customHeaders)
-    : DownloadJobBase(networkManager, url, customHeaders), timeoutTime(timeout), postData(postdata), buffer()
+    : DownloadJobBase(networkManager, url, customHeaders),
+      timeoutTimer(this),
+      timeoutTime(timeout),
+      postData(postdata),
+      contentDecoder(),
+      received(),
+      buffer(),
+      validationCache(nullptr),
+      notModified(false),
+      scanner()
 {
 }
 
 void DownloadBufferJob::start()
 {
+    running = true;
+
+    if (postToJobThread([this]() { start(); }))
+        return;
+
+    applyLearnedRedirect();
+    if (deferForRateLimit())
+        return;
+
     QNetworkRequest request(url);
 
     for (const auto &[name, value] : qAsConst(customHeaders))
         request.setRawHeader(name, value);
 
+    // with an explicit Accept-Encoding Qt leaves the body compressed,
+    // so the bytes on the wire can be measured
+    if (!request.hasRawHeader("Accept-Encoding"))
+        request.setRawHeader("Accept-Encoding", "gzip, deflate");
+
+    contentDecoder.reset();
+    received.clear();
+    timing.decodedBytes = -1;
+
     if (postData.isEmpty())
     {
+        if (validationCache)
+            validationCache->prepareRequest(url, request);
+
         reply.reset(networkManager->get(request));
     }
     else
@@ -27,112 +57,200 @@ void DownloadBufferJob::start()
     }
     //    reply->setParent(nullptr);
 
+    trackReply();
+
+    QObject::connect(reply.get(), &QNetworkReply::readyRead, this, &DownloadBufferJob::downloadReadyRead);
     QObject::connect(reply.get(), &QNetworkReply::finished, this, &DownloadBufferJob::downloadFinished);
     QObject::connect(reply.get(), &QNetworkReply::errorOccurred, this, &DownloadBufferJob::onError);
     QObject::connect(reply.get(), &QNetworkReply::sslErrors, this, &DownloadJobBase::onSslErrors);
 
     if (timeoutTime > 0)
     {
-        QObject::connect(&timeoutTimer, &QTimer::timeout, this, &DownloadBufferJob::timeout);
+        QObject::connect(&timeoutTimer, &QTimer::timeout, this, &DownloadBufferJob::timeout,
+                         Qt::UniqueConnection);
         timeoutTimer.start(timeoutTime);
     }
 }
 
 void DownloadBufferJob::restart()
 {
+    // reset right away, a caller looking at the job sees it running again
+    running = true;
     isCompleted = false;
-    errorString = "";
+    isCancelled = false;
+    setErrorString("");
+
+    if (postToJobThread([this]() { restart(); }))
+        return;
+
+    notModified = false;
     buffer.clear();
 
+    if (scanner)
+        scanner->reset();
+
     start();
 }
 
 void DownloadBufferJob::downloadReadyRead()
 {
-    // read it all at once when finished
-    // buffer.append(reply->readAll());
+    if (!contentDecoder)
+        contentDecoder.reset(new ContentDecoder(reply->rawHeader("Content-Encoding")));
+
+    if (!scanner)
+    {
+        contentDecoder->decode(reply->readAll(), received);
+        return;
+    }
+
+    QByteArray chunk;
+    contentDecoder->decode(reply->readAll(), chunk);
+    timing.decodedBytes = qMax<qint64>(0, timing.decodedBytes) + chunk.size();
+
+    // redirect and error bodies aren't part of the page
+    if (httpStatus >= 200 && httpStatus < 300)
+        scanner->feed(chunk);
 }
 
 void DownloadBufferJob::downloadFinished()
 {
     timeoutTimer.stop();
 
-    QUrl redirect = reply->attribute(QNetworkRequest::RedirectionTargetAttribute).toUrl();
-    if (redirect.isValid())
-    {
-        if (redirect.host() != "")
-        {
-            this->url = redirect.toString();
-        }
-        else
-        {
-            QUrl base(this->url);
-            base.setPath(redirect.path());
-            this->url = base.toString();
-        }
-        this->restart();
+    if (followRedirect() || refetchUnvalidated())
         return;
-    }
 
-    if (errorString != "" || (reply->error() != QNetworkReply::NoError))
+    if (errorString() != "" || (reply->error() != QNetworkReply::NoError))
     {
         // already handled
         // emit downloadError();
     }
     else
     {
-        buffer = reply->readAll();
+        buffer = readBody();
+
+        if (errorString() != "")
+        {
+            notifyError();
+            return;
+        }
 
         isCompleted = true;
 
-        emit completed();
+        notifyCompleted();
     }
 }
 
+bool DownloadBufferJob::refetchUnvalidated()
+{
+    // a 304 needs the cached copy, which may have been removed since the request was sent
+    HttpValidationEntry entry;
+    if (!validationCache || !postData.isEmpty() || httpStatus != 304 || validationCache->lookup(url, entry))
+        return false;
+
+    auto request = reply->request();
+    if (!request.hasRawHeader("If-None-Match") && !request.hasRawHeader("If-Modified-Since"))
+        return false;
+
+    // without an entry the request goes out without validators
+    qDebug() << "Not modified, but no cached copy of" << url;
+    restart();
+
+    return true;
+}
+
+bool DownloadBufferJob::isIdempotent() const
+{
+    return postData.isEmpty();
+}
+
+QByteArray DownloadBufferJob::readBody()
+{
+    downloadReadyRead();
+
+    auto body = received;
+    received.clear();
+
+    if (!contentDecoder->finish())
+    {
+        setErrorString("Download error: " + contentDecoder->errorString());
+        return QByteArray();
+    }
+
+    if (scanner)
+        scanner->finish();
+    else
+        timing.decodedBytes = body.size();
+
+    if (!validationCache || !postData.isEmpty())
+        return body;
+
+    if (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 304)
+    {
+        HttpValidationEntry entry;
+        if (!validationCache->lookup(url, entry))
+        {
+            setErrorString("Download error: not modified, but nothing cached");
+            return QByteArray();
+        }
+
+        notModified = true;
+        return entry.body;
+    }
+
+    validationCache->store(url, reply.get(), body);
+
+    return body;
+}
+
 void DownloadBufferJob::onError(QNetworkReply::NetworkError)
 {
     timeoutTimer.stop();
 
-    if (errorString == "")
-        errorString = "Download error: " + reply->errorString();
+    if (dropLearnedRedirect() || scheduleRetry())
+        return;
+
+    if (errorString() == "")
+        setErrorString("Download error: " + reply->errorString());
 
-    qDebug() << "Error string:" << errorString;
-    emit downloadError();
+    qDebug() << "Error string:" << errorString();
+    notifyError();
 }
 
 void DownloadBufferJob::timeout()
 {
-    errorString = "Download error: timeout";
+    networkError = QNetworkReply::TimeoutError;
     reply.get()->disconnect();
     reply->abort();
+
+    if (scheduleRetry())
+        return;
+
+    setErrorString("Download error: timeout");
+    notifyError();
 }
 
-bool DownloadBufferJob::await(int timeout, bool retry, int maxRetries)
+bool DownloadBufferJob::await(int timeout)
 {
-    timeoutTimer.stop();
-
     if (isCompleted)
         return true;
 
-    QElapsedTimer time;
-    time.start();
+    // all retries of a transient failure failed before, give it another round
+    if (errorString() != "" && !isCancelled && !errorString().contains("Protocol") &&
+        retryPolicy.isRetryable(isIdempotent(), httpStatus, networkError))
+    {
+        resetRetries();
+        restart();
+    }
+    else if (errorString() != "")
+    {
+        return false;
+    }
 
+    // retries are scheduled by the job itself, this only waits for the final outcome
     awaitSignal(this, {SIGNAL(completed()), SIGNAL(downloadError())}, timeout);
 
-    int rem = timeout - time.elapsed();
-    if (errorString != "")
-    {
-        if (!retry || errorString.contains("Protocol"))
-            return false;
-
-        if (rem > 0 && maxRetries > 0)
-        {
-            restart();
-            return await(rem, retry, maxRetries - 1);
-        }
-    }
-    if (rem <= 20)
-        errorString = "Download timeout.";
+    if (!isCompleted && errorString() == "")
+        setErrorString("Download timeout.");
 
     return isCompleted;
 }
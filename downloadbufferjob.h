@@ -1,7 +1,10 @@
 #ifndef DOWNLOADBUFFERJOB_H
 #define DOWNLOADBUFFERJOB_H
 
+#include "contentdecoder.h"
 #include "downloadjobbase.h"
+#include "htmlstreamscanner.h"
+#include "httpvalidationcache.h"
 
 class DownloadBufferJob : public DownloadJobBase
 {
@@ -12,20 +15,36 @@ protected:
     int timeoutTime;
     QByteArray postData;
 
+    // bodies are requested compressed and inflated while they arrive
+    QScopedPointer<ContentDecoder> contentDecoder;
+    QByteArray received;
+
     void downloadReadyRead();
     virtual void downloadFinished();
     void onError(QNetworkReply::NetworkError);
     void timeout();
+    bool refetchUnvalidated();
+    QByteArray readBody();
+    bool isIdempotent() const override;
 
 public:
     QByteArray buffer;
 
+    // GET requests are revalidated against this cache when set,
+    // notModified tells that the server answered 304 and buffer holds the cached body
+    HttpValidationCache *validationCache;
+    bool notModified;
+
+    // when set, the body is fed to the scanner while it arrives and not kept in buffer
+    QSharedPointer<HtmlStreamScanner> scanner;
+
     DownloadBufferJob(QNetworkAccessManager *networkManager, const QString &url, int timeout = 6000,
                       const QByteArray &postData = QByteArray(),
                       const QList<std::tuple<const char *, const char *>> &customHeaders = {});
     virtual ~DownloadBufferJob() = default;
 
-    bool await(int timeout = 7000, bool retry = true, int maxRetries = 10);
+    bool await(int timeout = 7000);
+    int timeoutMs() const { return timeoutTime; }
 
     void start() override;
     void restart() override;
@@ -5,12 +5,78 @@
 DownloadFileJob::DownloadFileJob(QNetworkAccessManager *networkManager, const QString &url,
                                  const QString &localFilePath,
                                  const QList<std::tuple<const char *, const char *>> &customHeaders)
-    : DownloadJobBase(networkManager, url, customHeaders), filepath(localFilePath)
+    : DownloadJobBase(networkManager, url, customHeaders),
+      file(this),
+      resumeOffset(0),
+      responseChecked(false),
+      responseAccepted(false),
+      filepath(localFilePath)
 {
 }
 
+QByteArray DownloadFileJob::validatorOf(QNetworkReply *reply)
+{
+    // If-Range only works with strong validators
+    auto etag = reply->rawHeader("ETag");
+    if (!etag.isEmpty() && !etag.startsWith("W/"))
+        return etag;
+
+    return reply->rawHeader("Last-Modified");
+}
+
+void DownloadFileJob::requestRange(QNetworkRequest &request, qint64 offset, const QByteArray &validator)
+{
+    request.setRawHeader("Range", "bytes=" + QByteArray::number(offset) + "-");
+    request.setRawHeader("If-Range", validator);
+}
+
+QByteArray DownloadFileJob::loadPartValidator()
+{
+    QFile meta(filepath + ".part.meta");
+    if (!meta.open(QIODevice::ReadOnly))
+        return QByteArray();
+
+    return meta.readAll();
+}
+
+void DownloadFileJob::savePartValidator(const QByteArray &validator)
+{
+    QFile meta(filepath + ".part.meta");
+
+    if (validator.isEmpty())
+        meta.remove();
+    else if (meta.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        meta.write(validator);
+}
+
+bool DownloadFileJob::canResume()
+{
+    return file.size() > 0 && QFile::exists(filepath + ".part.meta");
+}
+
+void DownloadFileJob::discardPartial()
+{
+    file.remove();
+    QFile::remove(filepath + ".part.meta");
+}
+
+bool DownloadFileJob::completeLocally()
+{
+    if (!QFile::exists(filepath))
+        return false;
+
+    isCompleted = true;
+
+    return true;
+}
+
 void DownloadFileJob::start()
 {
+    running = true;
+
+    if (postToJobThread([this]() { start(); }))
+        return;
+
     QString dirname = QFileInfo(filepath).path();
     QDir().mkpath(dirname);
 
@@ -19,19 +85,38 @@ void DownloadFileJob::start()
     if (QFile::exists(filepath))
     {
         isCompleted = true;
+        notifyCompleted();
     }
     else
     {
-        if (file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        applyLearnedRedirect();
+        if (deferForRateLimit())
+            return;
+
+        // continue a previous partial download if we know how to validate it
+        auto validator = loadPartValidator();
+        resumeOffset = validator.isEmpty() ? 0 : QFileInfo(file).size();
+        responseChecked = false;
+        responseAccepted = false;
+
+        auto mode = resumeOffset > 0 ? QIODevice::WriteOnly | QIODevice::Append
+                                     : QIODevice::WriteOnly | QIODevice::Truncate;
+
+        if (file.open(mode))
         {
             QNetworkRequest request(url);
 
             for (const auto &[name, value] : qAsConst(customHeaders))
                 request.setRawHeader(name, value);
 
+            if (resumeOffset > 0)
+                requestRange(request, resumeOffset, validator);
+
             reply.reset(networkManager->get(request));
             //            reply->setParent(nullptr);
 
+            trackReply();
+
             QObject::connect(reply.get(), &QNetworkReply::readyRead, this,
                              &DownloadFileJob::downloadFileReadyRead);
             QObject::connect(reply.get(), &QNetworkReply::finished, this,
@@ -41,22 +126,52 @@ void DownloadFileJob::start()
         }
         else
         {
-            errorString = "Can't create file.";
-            emit downloadError();
+            setErrorString("Can't create file.");
+            notifyError();
         }
     }
 }
 
 void DownloadFileJob::restart()
 {
+    // reset right away, a caller looking at the job sees it running again
+    running = true;
     isCompleted = false;
-    errorString = "";
+    isCancelled = false;
+    setErrorString("");
+
+    if (postToJobThread([this]() { restart(); }))
+        return;
+
     reply.reset();
     start();
 }
 
 void DownloadFileJob::downloadFileReadyRead()
 {
+    if (!responseChecked)
+    {
+        int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        responseChecked = true;
+        responseAccepted = status == 0 || (status >= 200 && status < 300);
+
+        if (status == 200)
+        {
+            // the file changed or the server ignored the range, start over
+            if (resumeOffset > 0)
+                file.resize(0);
+            resumeOffset = 0;
+            savePartValidator(validatorOf(reply.get()));
+        }
+    }
+
+    // don't write the body of redirects or error pages into the file
+    if (!responseAccepted)
+    {
+        reply->readAll();
+        return;
+    }
+
     file.write(reply->readAll());
 }
 
@@ -68,26 +183,21 @@ void DownloadFileJob::downloadFileFinished()
         file.close();
     }
 
-    QUrl redirect = reply->attribute(QNetworkRequest::RedirectionTargetAttribute).toUrl();
-    if (redirect.isValid() && reply->url() != redirect)
-    {
-        this->url = redirect.toString();
-        this->restart();
+    if (followRedirect())
         return;
-    }
 
     if (reply->error() != QNetworkReply::NoError)
     {
-        file.remove();
         onError(QNetworkReply::NetworkError());
     }
     else
     {
         isCompleted = true;
 
+        QFile::remove(filepath + ".part.meta");
         file.rename(filepath);
 
-        emit completed();
+        notifyCompleted();
     }
 }
 
@@ -99,13 +209,18 @@ void DownloadFileJob::onError(QNetworkReply::NetworkError)
         file.close();
     }
 
-    file.remove();
+    // keep what we got for a range request later on, unless the server refused the file
+    if (httpStatus >= 400 || !canResume())
+        discardPartial();
+
+    if (dropLearnedRedirect() || scheduleRetry())
+        return;
 
-    if (errorString == "")
-        errorString = "Download error: " + reply->errorString();
+    if (errorString() == "")
+        setErrorString("Download error: " + reply->errorString());
 
-    qDebug() << "Error string:" << errorString;
-    emit downloadError();
+    qDebug() << "Error string:" << errorString();
+    notifyError();
 }
 
 bool DownloadFileJob::await(int timeout)
@@ -115,10 +230,10 @@ bool DownloadFileJob::await(int timeout)
 
     awaitSignal(this, {SIGNAL(completed()), SIGNAL(downloadError())}, timeout);
 
-    if (errorString != "" || errorString.contains("Protocol"))
+    if (errorString() != "" || errorString().contains("Protocol"))
         return false;
     else if (!isCompleted)
-        errorString = "Download timeout.";
+        setErrorString("Download timeout.");
 
     return isCompleted;
 }
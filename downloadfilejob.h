@@ -10,6 +10,19 @@ class DownloadFileJob : public DownloadJobBase
 protected:
     QFile file;
 
+    // interrupted downloads keep their .part file and resume with a range request
+    // as long as the response carried a validator (stored in .part.meta)
+    qint64 resumeOffset;
+    bool responseChecked;
+    bool responseAccepted;
+
+    static QByteArray validatorOf(QNetworkReply *reply);
+    static void requestRange(QNetworkRequest &request, qint64 offset, const QByteArray &validator);
+    QByteArray loadPartValidator();
+    void savePartValidator(const QByteArray &validator);
+    virtual bool canResume();
+    virtual void discardPartial();
+
     virtual void downloadFileReadyRead();
     virtual void downloadFileFinished();
 
@@ -22,6 +35,7 @@ public:
 
     bool await(int timeout = 7000);
 
+    bool completeLocally() override;
     void start() override;
     void restart() override;
     void onError(QNetworkReply::NetworkError);
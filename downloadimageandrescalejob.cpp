@@ -1,94 +1,350 @@
 #include "downloadimageandrescalejob.h"
 
 DownloadScaledImageJob::DownloadScaledImageJob(
-    QNetworkAccessManager *networkManager, const QString &url, const QString &path, QSize screenSize,
-    Settings *settings, const QList<std::tuple<const char *, const char *>> &customHeaders,
-    const EncryptionDescriptor &encryption)
+    QNetworkAccessManager *networkManager, const QString &url, const QString &path,
+    const ImageProcessingParameters &parameters, ImageProcessingPipeline *pipeline,
+    const QList<std::tuple<const char *, const char *>> &customHeaders, const EncryptionDescriptor &encryption)
     : DownloadFileJob(networkManager, url, path, customHeaders),
+      hedging(nullptr),
+      mirrorUrl(),
+      variantArea(0),
+      blobStore(nullptr),
       resultImage(nullptr),
-      screenSize(screenSize),
-      settings(settings),
-      encryption(encryption)
+      parameters(parameters),
+      pipeline(pipeline),
+      encryption(encryption),
+      task(),
+      bytesFed(0),
+      replyFinished(false),
+      partialData(),
+      partialValidator(),
+      blobParameters(),
+      hedgeTimer(this),
+      hedgeReply()
 {
+    QObject::connect(pipeline, &ImageProcessingPipeline::inputAvailable, this,
+                     &DownloadScaledImageJob::feedPipeline);
+    QObject::connect(pipeline, &ImageProcessingPipeline::taskFinished, this,
+                     &DownloadScaledImageJob::processingFinished);
+
+    hedgeTimer.setSingleShot(true);
+    QObject::connect(&hedgeTimer, &QTimer::timeout, this, &DownloadScaledImageJob::sendHedge);
 }
 
-void DownloadScaledImageJob::downloadFileReadyRead()
+DownloadScaledImageJob::~DownloadScaledImageJob()
 {
-    // don't save to file because its gonna be rescaled anyway
-    //    file.write(reply->readAll());
+    // the pipeline may already be gone when the job is deleted late, only flag the task
+    if (task)
+        task->abort();
 }
 
-void DownloadScaledImageJob::downloadFileFinished()
+bool DownloadScaledImageJob::completeLocally()
+{
+    if (DownloadFileJob::completeLocally())
+        return true;
+
+    blobParameters = ImageBlobStore::parametersKey(parameters, encryption);
+    isCompleted = blobStore && blobStore->restore(originalUrl, blobParameters, filepath);
+
+    return isCompleted;
+}
+
+void DownloadScaledImageJob::start()
 {
-    if (file.isOpen())
+    running = true;
+
+    if (postToJobThread([this]() { start(); }))
+        return;
+
+    // another job may have written the page since, the callers still wait for the signal
+    if (QFile::exists(filepath))
+    {
+        isCompleted = true;
+        notifyCompleted();
+        return;
+    }
+
+    QDir().mkpath(QFileInfo(filepath).path());
+
+    abortProcessing();
+    cancelHedge();
+
+    blobParameters = ImageBlobStore::parametersKey(parameters, encryption);
+    if (blobStore && blobStore->restore(originalUrl, blobParameters, filepath))
+    {
+        isCompleted = true;
+        notifyCompleted();
+        return;
+    }
+
+    applyLearnedRedirect();
+    if (deferForRateLimit())
+        return;
+
+    task.reset(new ImageProcessingTask(filepath, parameters, encryption));
+    bytesFed = 0;
+    responseChecked = false;
+    responseAccepted = false;
+    replyFinished = false;
+
+    QNetworkRequest request(url);
+
+    for (const auto &[name, value] : qAsConst(customHeaders))
+        request.setRawHeader(name, value);
+
+    resumeOffset = canResume() ? partialData.size() : 0;
+    if (resumeOffset > 0)
+        requestRange(request, resumeOffset, partialValidator);
+    else
+        discardPartial();
+
+    reply.reset(networkManager->get(request));
+    trackReply();
+    connectReply();
+
+    // a resumed download continues its own range, a duplicate would have to start over
+    if (hedging && resumeOffset == 0)
     {
-        file.close();
-        file.remove();
+        hedging->requestStarted();
+        hedgeTimer.start(hedging->delay(QUrl(originalUrl).host()));
     }
+}
+
+void DownloadScaledImageJob::connectReply()
+{
+    // when the pipeline is saturated the data is left in the reply,
+    // a limited read buffer makes the network stack stop reading from the socket
+    reply->setReadBufferSize(512 * 1024);
+
+    QObject::connect(reply.get(), &QNetworkReply::readyRead, this,
+                     &DownloadScaledImageJob::downloadFileReadyRead);
+    QObject::connect(reply.get(), &QNetworkReply::finished, this,
+                     &DownloadScaledImageJob::downloadFileFinished);
+    QObject::connect(reply.get(), &QNetworkReply::errorOccurred, this, &DownloadFileJob::onError);
+    QObject::connect(reply.get(), &QNetworkReply::sslErrors, this, &DownloadJobBase::onSslErrors);
+
+    // answered in time, no duplicate needed
+    QObject::connect(reply.get(), &QNetworkReply::metaDataChanged, this,
+                     &DownloadScaledImageJob::cancelHedge);
+}
+
+void DownloadScaledImageJob::sendHedge()
+{
+    if (!reply || !reply->isRunning() || hedgeReply || !hedging->acquire())
+        return;
+
+    QNetworkRequest request(mirrorUrl.isEmpty() ? url : mirrorUrl);
+
+    for (const auto &[name, value] : qAsConst(customHeaders))
+        request.setRawHeader(name, value);
+
+    qDebug() << "Hedging stalled request" << url << "with" << request.url();
+
+    hedgeReply.reset(networkManager->get(request));
+    hedgeReply->setReadBufferSize(512 * 1024);
+    timing.hedges++;
 
-    QUrl redirect = reply->attribute(QNetworkRequest::RedirectionTargetAttribute).toUrl();
-    if (redirect.isValid() && reply->url() != redirect)
+    QObject::connect(hedgeReply.get(), &QNetworkReply::metaDataChanged, this,
+                     &DownloadScaledImageJob::hedgeResponded);
+    QObject::connect(hedgeReply.get(), &QNetworkReply::finished, this,
+                     &DownloadScaledImageJob::hedgeResponded);
+    QObject::connect(hedgeReply.get(), &QNetworkReply::sslErrors, this, &DownloadJobBase::onSslErrors);
+}
+
+void DownloadScaledImageJob::hedgeResponded()
+{
+    if (!hedgeReply)
+        return;
+
+    // only a body takes over, redirects and errors are left to the original request
+    int status = hedgeReply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (hedgeReply->error() != QNetworkReply::NoError || status < 200 || status >= 300)
     {
-        this->url = redirect.toString();
-        this->restart();
+        cancelHedge();
         return;
     }
 
+    auto stalled = reply.take();
+    stalled->disconnect(this);
+    stalled->abort();
+    stalled->deleteLater();
+
+    reply.reset(hedgeReply.take());
+    reply->disconnect(this);
+
+    // the headers of the duplicate were already seen, the attempt still counts from the original request
+    auto started = attemptStarted;
+    trackReply();
+    attemptStarted = started;
+    httpStatus = status;
+    headersReceived = timingNow();
+    timing.firstByte = headersReceived - attemptStarted;
+    timing.hedgeWins++;
+
+    connectReply();
+
+    if (reply->isFinished())
+        downloadFileFinished();
+    else
+        feedPipeline();
+}
+
+void DownloadScaledImageJob::cancelHedge()
+{
+    hedgeTimer.stop();
+
+    if (!hedgeReply)
+        return;
+
+    // may be called from a signal of the reply, it is deleted later
+    auto hedge = hedgeReply.take();
+    hedge->disconnect(this);
+    hedge->abort();
+    hedge->deleteLater();
+}
+
+void DownloadScaledImageJob::downloadFileReadyRead()
+{
+    feedPipeline();
+}
+
+void DownloadScaledImageJob::downloadFileFinished()
+{
+    if (followRedirect())
+        return;
+
     if (reply->error() != QNetworkReply::NoError)
     {
+        abortProcessing();
+        cancelHedge();
         onError(QNetworkReply::NetworkError());
     }
     else
     {
-        if (processImage(reply->readAll()))
+        replyFinished = true;
+        feedPipeline();
+    }
+}
+
+void DownloadScaledImageJob::feedPipeline()
+{
+    if (!reply || !task)
+        return;
+
+    if (!responseChecked)
+    {
+        // don't feed the body of redirects or error pages into the pipeline
+        int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        responseChecked = true;
+        responseAccepted = status == 0 || (status >= 200 && status < 300);
+
+        if (responseAccepted && status != 206)
         {
-            isCompleted = true;
-            emit completed();
+            // the image changed or the server ignored the range, start over
+            partialData.clear();
+            partialValidator = validatorOf(reply.get());
         }
-        else
+    }
+
+    if (!responseAccepted)
+    {
+        reply->readAll();
+        return;
+    }
+
+    // a resumed download first replays the bytes of the previous attempts
+    while (pipeline->acceptsInput())
+    {
+        if (bytesFed == partialData.size())
         {
-            errorString = "Failed to load or process image.";
-            emit downloadError();
+            if (reply->bytesAvailable() == 0)
+                break;
+            partialData.append(reply->read(128 * 1024));
         }
+
+        auto data = partialData.mid(bytesFed, 128 * 1024);
+        auto size = data.size();
+        pipeline->feed(task, std::move(data), bytesFed, false);
+        bytesFed += size;
+    }
+
+    if (replyFinished && reply->bytesAvailable() == 0 && bytesFed == partialData.size())
+    {
+        // the last chunk is only sent once
+        pipeline->feed(task, QByteArray(), bytesFed, true);
+        replyFinished = false;
     }
 }
 
-bool DownloadScaledImageJob::processImage(QByteArray &&array)
+void DownloadScaledImageJob::abort()
 {
-    //    QElapsedTimer t;
-    //    t.start();
+    if (postToJobThread([this]() { abort(); }))
+        return;
 
-    if (encryption.type == XorEncryption)
+    cancelHedge();
+
+    if (task && !(reply && reply->isRunning()))
     {
-#ifdef KOBO
-        decryptXorInplace_NEON(array, encryption.key);
-#else
-        decryptXorInplace(array, encryption.key);
-#endif
+        // the download is done but the image is still being processed
+        abortProcessing();
+        isCancelled = true;
+        setErrorString("Download cancelled.");
+        notifyError();
+        return;
     }
 
-    //    qDebug() << "Image processing decrypt:" << t.elapsed();
-    QImage pimg;
+    DownloadFileJob::abort();
+}
+
+bool DownloadScaledImageJob::canResume()
+{
+    return !partialData.isEmpty() && !partialValidator.isEmpty();
+}
+
+void DownloadScaledImageJob::discardPartial()
+{
+    partialData.clear();
+    partialValidator.clear();
+}
+
+void DownloadScaledImageJob::abortProcessing()
+{
+    if (task)
+        pipeline->cancel(task);
+    task.clear();
+}
+
+void DownloadScaledImageJob::processingFinished(QSharedPointer<ImageProcessingTask> finishedTask)
+{
+    if (finishedTask != task)
+        return;
+
+    task.clear();
+
+    // partialData holds the whole source at this point
+    if (blobStore && !finishedTask->result.isNull())
+        blobStore->store(originalUrl, blobParameters, partialData, filepath);
 
-    if (isJpeg(array) || isPng(array))
-        pimg = processImageN(array, filepath, screenSize, settings->doublePageMode, settings->trimPages,
-                             settings->manhwaMode, settings->ditheringMode == SWHWDithering);
-    if (!pimg.isNull())
+    discardPartial();
+
+    timing.decrypt = finishedTask->encryption.type != NoEncryption ? finishedTask->decryptTime : -1;
+    timing.decode = finishedTask->decodeTime;
+    timing.transform = finishedTask->transformTime;
+    timing.encode = finishedTask->encodeTime;
+
+    // the encoded size grows roughly with the pixel count
+    if (variantArea > 0 && variantArea < 1)
+        timing.variantBytesSaved = timing.bytes * (1 / variantArea - 1);
+
+    if (!finishedTask->result.isNull())
     {
-        resultImage.reset(new QImage(pimg));
+        resultImage.reset(new QImage(finishedTask->result));
+        isCompleted = true;
+        notifyCompleted();
     }
     else
     {
-        qDebug() << "Fast decoding failed, using fallback!";
-
-        pimg = processImageQt(array, filepath, screenSize, settings->doublePageMode, settings->trimPages,
-                              settings->manhwaMode, settings->ditheringMode == SWHWDithering);
-
-        if (!pimg.isNull())
-            resultImage.reset(new QImage(pimg));
+        setErrorString("Failed to load or process image.");
+        notifyError();
     }
-
-    //    qDebug() << "Image processing:" << t.elapsed();
-
-    return !pimg.isNull();
 }
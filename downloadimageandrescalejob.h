@@ -4,45 +4,75 @@
 #include <QImage>
 
 #include "downloadfilejob.h"
+#include "imageblobstore.h"
 #include "imageprocessingnative.h"
+#include "imageprocessingpipeline.h"
 #include "imageprocessingqt.h"
-#include "settings.h"
+#include "requesthedging.h"
 #include "utils.h"
 
-enum EncryptionType
-{
-    NoEncryption = 0,
-    XorEncryption
-};
-
-struct EncryptionDescriptor
-{
-    EncryptionType type = NoEncryption;
-    QByteArray key = {};
-};
-
 class DownloadScaledImageJob : public DownloadFileJob
 {
     Q_OBJECT
 
 public:
+    // parameters is a snapshot of the settings taken on the gui thread, the job runs on the network thread
     DownloadScaledImageJob(QNetworkAccessManager *networkManager, const QString &url, const QString &path,
-                           QSize screenSize, Settings *settings,
+                           const ImageProcessingParameters &parameters, ImageProcessingPipeline *pipeline,
                            const QList<std::tuple<const char *, const char *>> &customHeaders = {},
                            const EncryptionDescriptor &encryption = {});
-    virtual ~DownloadScaledImageJob() = default;
+    virtual ~DownloadScaledImageJob();
+
+    // a request without a first byte after the hedging delay gets a duplicate to mirrorUrl
+    // (or url without a mirror), the first one to answer is kept and the other one cancelled
+    RequestHedging *hedging;
+    QString mirrorUrl;
+
+    // share of the original resolution's pixels when a smaller upstream variant is downloaded, 0 if unknown
+    double variantArea;
+
+    // pages processed before under the same url are restored from it instead of downloaded
+    ImageBlobStore *blobStore;
+
+    bool completeLocally() override;
+    void start() override;
+    void abort() override;
 
     void downloadFileReadyRead() override;
     void downloadFileFinished() override;
 
     QSharedPointer<QImage> resultImage;
 
+protected:
+    bool canResume() override;
+    void discardPartial() override;
+
 private:
-    QSize screenSize;
-    Settings *settings;
+    ImageProcessingParameters parameters;
+    ImageProcessingPipeline *pipeline;
     EncryptionDescriptor encryption;
 
-    bool processImage(QByteArray &&array);
+    QSharedPointer<ImageProcessingTask> task;
+    qint64 bytesFed;
+    bool replyFinished;
+
+    // encoded bytes received so far, replayed into a new task when a range request resumes them
+    QByteArray partialData;
+    QByteArray partialValidator;
+
+    QByteArray blobParameters;
+
+    QTimer hedgeTimer;
+    QScopedPointer<QNetworkReply> hedgeReply;
+
+    void connectReply();
+    void sendHedge();
+    void hedgeResponded();
+    void cancelHedge();
+
+    void feedPipeline();
+    void abortProcessing();
+    void processingFinished(QSharedPointer<ImageProcessingTask> finishedTask);
 };
 
 #endif  // DOWNLOADIMAGEANDRESCALEJOB_H
@@ -5,11 +5,228 @@ DownloadJobBase::DownloadJobBase(QNetworkAccessManager *networkManager, const QS
     : networkManager(networkManager),
       reply(),
       customHeaders(customHeaders),
+      retryTimer(this),
+      attemptsTimer(),
+      retryAfter(-1),
+      running(false),
+      stateMutex(),
+      errorMessage(),
+      timingClock(),
+      attemptStarted(0),
+      connectStarted(-1),
+      requestSent(-1),
+      headersReceived(-1),
       url(url),
       originalUrl(url),
       isCompleted(false),
-      errorString()
+      isCancelled(false),
+      httpStatus(0),
+      networkError(QNetworkReply::NoError),
+      bytesReceived(0),
+      timing(),
+      retryPolicy(),
+      retries(0),
+      redirectCache(nullptr),
+      redirectLearned(false),
+      redirectPermanent(true),
+      rateLimiter(nullptr),
+      rateReserved(false)
 {
+    retryTimer.setSingleShot(true);
+    QObject::connect(&retryTimer, &QTimer::timeout, this, [this]() { restart(); });
+    QObject::connect(this, &DownloadJobBase::completed, this, &DownloadJobBase::learnRedirect);
+    QObject::connect(this, &DownloadJobBase::completed, this, [this]() {
+        if (rateLimiter)
+            rateLimiter->succeeded(QUrl(url).host());
+    });
+
+    resetRetries();
+}
+
+void DownloadJobBase::resetRetries()
+{
+    if (postToJobThread([this]() { resetRetries(); }))
+        return;
+
+    retryTimer.stop();
+    rateReserved = false;
+    retries = 0;
+    attemptsTimer.start();
+
+    timing = RequestTiming();
+    timingClock.start();
+}
+
+qint64 DownloadJobBase::timingNow() const
+{
+    return timingClock.nsecsElapsed() / 1000;
+}
+
+QString DownloadJobBase::errorString() const
+{
+    QMutexLocker locker(&stateMutex);
+
+    return errorMessage;
+}
+
+void DownloadJobBase::setErrorString(const QString &error)
+{
+    QMutexLocker locker(&stateMutex);
+
+    errorMessage = error;
+}
+
+bool DownloadJobBase::isRunning() const
+{
+    return running;
+}
+
+bool DownloadJobBase::isIdempotent() const
+{
+    return true;
+}
+
+bool DownloadJobBase::scheduleRetry()
+{
+    if (retryTimer.isActive())
+        return true;
+
+    if (isCancelled || !retryPolicy.isRetryable(isIdempotent(), httpStatus, networkError))
+        return false;
+
+    int delay = retryPolicy.delay(retries, retryAfter);
+    if (!retryPolicy.allowsRetry(retries, attemptsTimer.elapsed(), delay))
+        return false;
+
+    retries++;
+    qDebug() << "Retry" << retries << "of" << url << "in" << delay << "ms";
+
+    retryTimer.start(delay);
+
+    return true;
+}
+
+bool DownloadJobBase::deferForRateLimit()
+{
+    if (!rateLimiter)
+        return false;
+
+    // the slot was taken before the wait, only a pause of the host that started since delays it further
+    int wait = rateReserved ? rateLimiter->pause(QUrl(url).host()) : rateLimiter->reserve(QUrl(url).host());
+    rateReserved = wait > 0;
+    if (!rateReserved)
+        return false;
+
+    retryTimer.start(wait);
+
+    return true;
+}
+
+void DownloadJobBase::applyLearnedRedirect()
+{
+    if (!redirectCache || url != originalUrl)
+        return;
+
+    auto target = redirectCache->resolve(url);
+    if (target.isEmpty())
+        return;
+
+    url = target;
+    redirectLearned = true;
+    timing.redirectsSaved++;
+}
+
+bool DownloadJobBase::followRedirect()
+{
+    QUrl redirect = reply->attribute(QNetworkRequest::RedirectionTargetAttribute).toUrl();
+    if (!redirect.isValid() || reply->url() == redirect)
+        return false;
+
+    // only a chain of permanent redirects is remembered for long
+    if (timing.redirects == 0)
+        redirectPermanent = true;
+    redirectPermanent = redirectPermanent && (httpStatus == 301 || httpStatus == 308);
+
+    url = QUrl(url).resolved(redirect).toString();
+    timing.redirects++;
+    restart();
+
+    return true;
+}
+
+bool DownloadJobBase::dropLearnedRedirect()
+{
+    // the learned location went stale, forget it and ask the original url again
+    if (!redirectLearned ||
+        !((httpStatus >= 400 && httpStatus < 500) || networkError == QNetworkReply::HostNotFoundError))
+        return false;
+
+    qDebug() << "Dropping learned redirect" << originalUrl << "->" << url;
+
+    redirectCache->invalidate(originalUrl);
+    redirectLearned = false;
+    url = originalUrl;
+    retryTimer.start(0);
+
+    return true;
+}
+
+void DownloadJobBase::learnRedirect()
+{
+    if (redirectCache && timing.redirects > 0 && url != originalUrl)
+        redirectCache->learn(originalUrl, url, redirectPermanent);
+}
+
+bool DownloadJobBase::postToJobThread(const std::function<void()> &call)
+{
+    if (QThread::currentThread() == thread())
+        return false;
+
+    QMetaObject::invokeMethod(this, call, Qt::QueuedConnection);
+
+    return true;
+}
+
+void DownloadJobBase::notifyCompleted()
+{
+    running = false;
+
+    if (QThread::currentThread() == qApp->thread())
+    {
+        emit completed();
+        return;
+    }
+
+    // the job is kept alive until the signal was delivered
+    QMetaObject::invokeMethod(
+        qApp, [job = sharedFromThis()]() {
+            if (job)
+                emit job->completed();
+        },
+        Qt::QueuedConnection);
+}
+
+void DownloadJobBase::notifyError()
+{
+    running = false;
+
+    if (QThread::currentThread() == qApp->thread())
+    {
+        emit downloadError();
+        return;
+    }
+
+    QMetaObject::invokeMethod(
+        qApp, [job = sharedFromThis()]() {
+            if (job)
+                emit job->downloadError();
+        },
+        Qt::QueuedConnection);
+}
+
+bool DownloadJobBase::completeLocally()
+{
+    return false;
 }
 
 QList<QNetworkCookie> DownloadJobBase::getCookies()
@@ -17,6 +234,83 @@ QList<QNetworkCookie> DownloadJobBase::getCookies()
     return reply->header(QNetworkRequest::SetCookieHeader).value<QList<QNetworkCookie>>();
 }
 
+void DownloadJobBase::trackReply()
+{
+    httpStatus = 0;
+    networkError = QNetworkReply::NoError;
+    bytesReceived = 0;
+    retryAfter = -1;
+
+    attemptStarted = timingNow();
+    connectStarted = -1;
+    requestSent = -1;
+    headersReceived = -1;
+
+    auto r = reply.get();
+    QObject::connect(r, &QNetworkReply::metaDataChanged, this, [this, r]() {
+        httpStatus = r->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        retryAfter = RetryPolicy::parseRetryAfter(r->rawHeader("Retry-After"));
+
+        if (rateLimiter && (httpStatus == 429 || httpStatus == 503))
+            rateLimiter->throttle(QUrl(url).host(), retryAfter);
+
+        if (headersReceived < 0)
+        {
+            headersReceived = timingNow();
+            timing.firstByte = headersReceived - (requestSent >= 0 ? requestSent : attemptStarted);
+        }
+    });
+    QObject::connect(r, &QNetworkReply::downloadProgress, this,
+                     [this](qint64 received, qint64) { bytesReceived = received; });
+
+    // Qt doesn't tell the dns lookup, tcp and tls handshake apart, they are measured together.
+    // encrypted() is only emitted for a new connection, before Qt 6.3 it is measured from the start
+    // of the attempt and plain http connections aren't measured at all
+    QObject::connect(r, &QNetworkReply::encrypted, this, [this]() {
+        timing.connect = timingNow() - (connectStarted >= 0 ? connectStarted : attemptStarted);
+    });
+#if QT_VERSION >= QT_VERSION_CHECK(6, 3, 0)
+    QObject::connect(r, &QNetworkReply::socketStartedConnecting, this, [this]() {
+        if (connectStarted < 0)
+            connectStarted = timingNow();
+    });
+    QObject::connect(r, &QNetworkReply::requestSent, this, [this]() {
+        requestSent = timingNow();
+        if (connectStarted >= 0 && url.startsWith("http:"))
+            timing.connect = requestSent - connectStarted;
+    });
+#endif
+    QObject::connect(r, &QNetworkReply::finished, this, [this]() {
+        auto now = timingNow();
+        if (headersReceived >= 0)
+            timing.transfer = now - headersReceived;
+        timing.total = now;
+        timing.bytes = bytesReceived;
+    });
+    QObject::connect(r, &QNetworkReply::errorOccurred, this,
+                     [this](QNetworkReply::NetworkError error) { networkError = error; });
+}
+
+void DownloadJobBase::abort()
+{
+    if (postToJobThread([this]() { abort(); }))
+        return;
+
+    if (retryTimer.isActive())
+    {
+        retryTimer.stop();
+        isCancelled = true;
+        setErrorString("Download cancelled.");
+        notifyError();
+    }
+    else if (reply && reply->isRunning())
+    {
+        isCancelled = true;
+        setErrorString("Download cancelled.");
+        reply->abort();
+    }
+}
+
 void DownloadJobBase::onSslErrors(const QList<QSslError> &errors)
 {
     foreach (const QSslError &ssle, errors)
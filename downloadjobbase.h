@@ -1,10 +1,17 @@
 #ifndef DOWNLOADJOBBASE_H
 #define DOWNLOADJOBBASE_H
 
+#include <QSharedPointer>
 #include <QTime>
 #include <QtNetwork>
+#include <atomic>
 
-class DownloadJobBase : public QObject
+#include "networkmetrics.h"
+#include "ratelimiter.h"
+#include "redirectcache.h"
+#include "retrypolicy.h"
+
+class DownloadJobBase : public QObject, public QEnableSharedFromThis<DownloadJobBase>
 {
     Q_OBJECT
 
@@ -13,6 +20,44 @@ protected:
     QScopedPointer<QNetworkReply> reply;
     QList<std::tuple<const char *, const char *>> customHeaders;
 
+    QTimer retryTimer;
+    QElapsedTimer attemptsTimer;
+    int retryAfter;
+
+    // set when the job is (re)started and cleared when completed() or downloadError() is sent,
+    // other threads read it instead of the reply and the timers of the job thread
+    std::atomic<bool> running;
+
+    // the outcome is written on the job thread and by callers resetting or awaiting the job
+    mutable QMutex stateMutex;
+    QString errorMessage;
+
+    // start of the first attempt and the phases of the current one, in microseconds
+    QElapsedTimer timingClock;
+    qint64 attemptStarted;
+    qint64 connectStarted;
+    qint64 requestSent;
+    qint64 headersReceived;
+
+    qint64 timingNow() const;
+    void setErrorString(const QString &error);
+    void trackReply();
+    virtual bool isIdempotent() const;
+    bool scheduleRetry();
+
+    bool deferForRateLimit();
+    void applyLearnedRedirect();
+    bool followRedirect();
+    bool dropLearnedRedirect();
+    void learnRedirect();
+
+    // jobs live on the network thread, calls made from another thread are queued to it
+    bool postToJobThread(const std::function<void()> &call);
+    // completed() and downloadError() are always emitted on the main thread, where the
+    // callers check the state of the job before connecting to them
+    void notifyCompleted();
+    void notifyError();
+
 signals:
     void completed();
     void downloadError();
@@ -24,13 +69,42 @@ public:
 
     QString url;
     QString originalUrl;
-    bool isCompleted;
-    QString errorString;
+    std::atomic<bool> isCompleted;
+    std::atomic<bool> isCancelled;
+    QString errorString() const;
+
+    // outcome of the last request, used for tuning the download parallelism
+    int httpStatus;
+    QNetworkReply::NetworkError networkError;
+    qint64 bytesReceived;
+    RequestTiming timing;
+
+    // failed attempts are restarted on a timer as long as the policy allows it,
+    // downloadError() is only emitted once no retry is left
+    RetryPolicy retryPolicy;
+    int retries;
+
+    // GET requests start at the location learned from earlier redirects when set,
+    // redirectLearned tells that url was taken from the cache
+    RedirectCache *redirectCache;
+    bool redirectLearned;
+    bool redirectPermanent;
+
+    // requests wait for a slot of their host when set, 429/503 answers slow the host down
+    RateLimiter *rateLimiter;
+    bool rateReserved;
+
+    void resetRetries();
+    bool isRunning() const;
 
     QList<QNetworkCookie> getCookies();
 
+    // finishes the job from what is already on disk, without a request
+    virtual bool completeLocally();
+
     virtual void start() = 0;
     virtual void restart() = 0;
+    virtual void abort();
     virtual void onSslErrors(const QList<QSslError> &);
 };
 
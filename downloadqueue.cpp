@@ -2,6 +2,18 @@
 
 #include "utils.h"
 
+static QString hostOf(const QString& url)
+{
+    return QUrl(url).host();
+}
+
+static bool isCongestion(const DownloadJobBase* job)
+{
+    return job->httpStatus == 429 || job->httpStatus == 503 ||
+           job->networkError == QNetworkReply::TimeoutError ||
+           job->networkError == QNetworkReply::RemoteHostClosedError;
+}
+
 // Download as strings
 DownloadQueue::DownloadQueue(NetworkManager* networkManager, const QList<QString>& urls,
                              int parallelDownloads,
@@ -10,21 +22,25 @@ DownloadQueue::DownloadQueue(NetworkManager* networkManager, const QList<QString
     : QObject(),
       completed(0),
       errors(0),
+      cancelled(0),
       lastErrorMessage(""),
       cancelOnError(cancelOnError),
       networkManager(networkManager),
       runningJobs(0),
       type(DownloadTypeString),
       parallelDownloads(parallelDownloads),
-      jobDescriptorQueue(),
+      maxParallelDownloads(0),
+      pendingJobs(DownloadPriorityCount),
+      running(),
       lambda(lambda),
+      newScanner(nullptr),
       individualTimeout(individualTimeout),
       cancellationToken(nullptr)
 {
     totalJobs = urls.count();
 
-    std::transform(urls.begin(), urls.end(), std::back_inserter(jobDescriptorQueue),
-                   [](const QString& s) { return FileDownloadDescriptor(s, ""); });
+    for (const auto& url : urls)
+        enqueue(FileDownloadDescriptor(url, ""));
 }
 
 // Download as images
@@ -33,43 +49,189 @@ DownloadQueue::DownloadQueue(NetworkManager* networkManager, const QList<FileDow
     : QObject(),
       completed(0),
       errors(0),
+      cancelled(0),
       lastErrorMessage(""),
       cancelOnError(cancelOnError),
       networkManager(networkManager),
       type(DownloadTypeScaledImage),
       parallelDownloads(parallelDownloads),
-      jobDescriptorQueue(),
+      maxParallelDownloads(0),
+      pendingJobs(DownloadPriorityCount),
+      running(),
       lambda(nullptr),
+      newScanner(nullptr),
       individualTimeout(-1),
       cancellationToken(nullptr)
 {
     totalJobs = urlAndPaths.count();
 
-    this->jobDescriptorQueue.append(urlAndPaths);
+    for (const auto& descriptor : urlAndPaths)
+        enqueue(descriptor);
 }
 
 void DownloadQueue::start()
 {
-    while (!jobDescriptorQueue.empty() && runningJobs < parallelDownloads)
-        startSingle();
+    if (cancellationToken != nullptr && cancellationToken->isCancelled())
+    {
+        cancelAll();
+        return;
+    }
+
+    bool started = true;
+    while (started)
+        started = startSingle();
+
+    preempt();
+}
+
+bool DownloadQueue::hasPendingJobs() const
+{
+    for (const auto& queue : pendingJobs)
+        if (!queue.empty())
+            return true;
+
+    return false;
 }
 
-void DownloadQueue::startSingle()
+void DownloadQueue::enqueue(const FileDownloadDescriptor& descriptor)
 {
-    if (jobDescriptorQueue.empty())
-        return;
+    pendingJobs[descriptor.priority].enqueue(descriptor);
+    pendingJobs[descriptor.priority].last().queued.start();
+}
+
+bool DownloadQueue::promoteDuplicate(const FileDownloadDescriptor& descriptor)
+{
+    for (auto& r : running)
+    {
+        if (r.descriptor.url == descriptor.url)
+        {
+            // protect it from being preempted by the classes it now serves
+            if (descriptor.priority < r.descriptor.priority)
+                r.descriptor.priority = descriptor.priority;
+            return true;
+        }
+    }
+
+    for (int p = 0; p < DownloadPriorityCount; p++)
+    {
+        auto& queue = pendingJobs[p];
+        for (int i = 0; i < queue.count(); i++)
+        {
+            if (queue[i].url == descriptor.url)
+            {
+                if (descriptor.priority < p)
+                {
+                    queue.removeAt(i);
+                    enqueue(descriptor);
+                }
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+int DownloadQueue::hostLimit(const QString& host)
+{
+    int limit = networkManager->adaptiveParallelism()->limit(host, parallelDownloads);
+    int maxConnections = networkManager->hostConnectionPolicy(host).maxConnections;
 
+    return maxConnections > 0 ? qMin(limit, maxConnections) : limit;
+}
+
+void DownloadQueue::preempt()
+{
+    for (int p = 0; p < DownloadPriorityCount; p++)
+    {
+        for (const auto& descriptor : qAsConst(pendingJobs[p]))
+        {
+            auto host = hostOf(descriptor.url);
+
+            // pick the lowest priority running download of the same host,
+            // the most recently started one within a class
+            int victim = -1;
+            for (int i = 0; i < running.count(); i++)
+                if (running[i].host == host && running[i].descriptor.priority > p &&
+                    (victim < 0 || running[i].descriptor.priority >= running[victim].descriptor.priority))
+                    victim = i;
+
+            if (victim < 0)
+                continue;
+
+            auto preempted = running.takeAt(victim);
+            detach(preempted);
+            runningJobs--;
+
+            // it is resumed first once its class gets a slot again
+            pendingJobs[preempted.descriptor.priority].prepend(preempted.descriptor);
+            pendingJobs[preempted.descriptor.priority].first().queued.start();
+
+            qDebug() << "Preempted download:" << preempted.descriptor.url << diagnostics();
+
+            start();
+            return;
+        }
+    }
+}
+
+void DownloadQueue::detach(RunningDownload& download)
+{
+    QObject::disconnect(download.job.get(), nullptr, this, nullptr);
+    networkManager->adaptiveParallelism()->downloadFinished(download.host);
+
+    // jobs are shared through the caches of NetworkManager, e.g. a preload with the visible page.
+    // Dropping the last reference deletes the job, which aborts its request and processing,
+    // a job someone else still holds keeps running for them.
+    download.job.clear();
+}
+
+bool DownloadQueue::startSingle()
+{
+    if (maxParallelDownloads > 0 && running.count() >= maxParallelDownloads)
+        return false;
+
+    // the highest priority download whose host has a free slot, counting the downloads of all queues
+    auto parallelism = networkManager->adaptiveParallelism();
+    for (int p = 0; p < DownloadPriorityCount; p++)
+    {
+        auto& queue = pendingJobs[p];
+        for (int i = 0; i < queue.count(); i++)
+        {
+            auto host = hostOf(queue[i].url);
+            if (parallelism->running(host) < hostLimit(host))
+            {
+                startDescriptor(queue.takeAt(i));
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+void DownloadQueue::startDescriptor(const FileDownloadDescriptor& descriptor)
+{
     runningJobs++;
 
-    auto descriptor = jobDescriptorQueue.dequeue();
+    networkManager->networkMetrics()->record(hostOf(descriptor.url), "queue",
+                                             descriptor.queued.nsecsElapsed() / 1000);
 
     QSharedPointer<DownloadJobBase> job;
 
-    if (type == DownloadTypeString)
+    if (type == DownloadTypeString && newScanner)
+        job = networkManager->downloadAndScan(descriptor.url, newScanner(), individualTimeout);
+    else if (type == DownloadTypeString)
         job = networkManager->downloadAsString(descriptor.url, individualTimeout);
     else  // if (type == DownloadTypeScaledImage)
         job = networkManager->downloadAsScaledImage(descriptor.url, descriptor.path);
 
+    RunningDownload r{descriptor, job, hostOf(descriptor.url), QElapsedTimer()};
+    r.timer.start();
+    running.append(r);
+
+    networkManager->adaptiveParallelism()->downloadStarted(r.host);
+
     if (!job->isCompleted)
     {
         QObject::connect(job.get(), &DownloadJobBase::completed, this,
@@ -79,12 +241,28 @@ void DownloadQueue::startSingle()
     }
     else
     {
-        downloadFinished(job, job->errorString == "");
+        downloadFinished(job, job->errorString() == "");
     }
 }
 
 void DownloadQueue::downloadFinished(QSharedPointer<DownloadJobBase> job, bool success)
 {
+    for (int i = 0; i < running.count(); i++)
+    {
+        if (running[i].job == job)
+        {
+            auto r = running.takeAt(i);
+            auto parallelism = networkManager->adaptiveParallelism();
+            parallelism->downloadFinished(r.host);
+
+            if (success && job->bytesReceived > 0)
+                parallelism->downloadSucceeded(r.host, job->bytesReceived, r.timer.elapsed());
+            else if (!success && isCongestion(job.get()))
+                parallelism->downloadCongested(r.host);
+            break;
+        }
+    }
+
     if (success)
     {
         if (lambda != nullptr)
@@ -101,20 +279,13 @@ void DownloadQueue::downloadFinished(QSharedPointer<DownloadJobBase> job, bool s
     else
     {
         errors++;
-        lastErrorMessage = job->errorString;
+        lastErrorMessage = job->errorString();
         if (cancelOnError)
             clearQuene();
-        emit singleDownloadFailed(job->originalUrl, job->errorString);
-    }
-
-    if (cancellationToken != nullptr && *cancellationToken)
-    {
-        errors++;
-        lastErrorMessage = "Download cancelled";
-        clearQuene();
+        emit singleDownloadFailed(job->originalUrl, job->errorString());
     }
 
-    job->disconnect();
+    QObject::disconnect(job.get(), nullptr, this, nullptr);
 
     completed++;
     runningJobs--;
@@ -125,47 +296,152 @@ void DownloadQueue::downloadFinished(QSharedPointer<DownloadJobBase> job, bool s
         emit allCompleted();
     }
     else
-        startSingle();
+        start();
 }
 
 void DownloadQueue::appendDownload(const FileDownloadDescriptor& urlAndPaths)
 {
-    totalJobs++;
-
-    this->jobDescriptorQueue.append(urlAndPaths);
+    if (!promoteDuplicate(urlAndPaths))
+    {
+        totalJobs++;
+        enqueue(urlAndPaths);
+    }
     start();
 }
 
 void DownloadQueue::appendDownloads(const QList<FileDownloadDescriptor>& urlAndPaths)
 {
-    totalJobs += urlAndPaths.count();
-
-    this->jobDescriptorQueue.append(urlAndPaths);
+    for (const auto& descriptor : urlAndPaths)
+    {
+        if (!promoteDuplicate(descriptor))
+        {
+            totalJobs++;
+            enqueue(descriptor);
+        }
+    }
     start();
 }
 
 void DownloadQueue::clearQuene()
 {
-    int c = jobDescriptorQueue.count();
-    jobDescriptorQueue.clear();
-    totalJobs -= c;
+    for (auto& queue : pendingJobs)
+    {
+        totalJobs -= queue.count();
+        queue.clear();
+    }
+}
+
+void DownloadQueue::cancelAll()
+{
+    int pending = 0;
+    for (const auto& queue : qAsConst(pendingJobs))
+        pending += queue.count();
+
+    clearQuene();
+
+    auto aborted = running;
+    running.clear();
+
+    for (auto& r : aborted)
+        detach(r);
+
+    runningJobs -= aborted.count();
+    totalJobs -= aborted.count();
+
+    if (pending + aborted.count() == 0)
+        return;
+
+    cancelled += pending + aborted.count();
+    lastErrorMessage = "Download cancelled";
+
+    emit progress(completed, totalJobs, errors);
+
+    if (completed == totalJobs)
+        emit allCompleted();
 }
 
 void DownloadQueue::resetJobCount()
 {
     errors = 0;
+    cancelled = 0;
     totalJobs = 0;
     completed = 0;
 }
 
 bool DownloadQueue::awaitCompletion()
 {
-    awaitSignal(this, {SIGNAL(allCompleted())}, -1);
+    if (completed < totalJobs)
+        awaitSignal(this, {SIGNAL(allCompleted())}, -1);
 
-    return errors == 0;
+    return errors == 0 && cancelled == 0;
 }
 
-void DownloadQueue::setCancellationToken(bool* token)
+void DownloadQueue::setCancellationToken(CancellationToken* token)
 {
+    if (cancellationToken != nullptr)
+        QObject::disconnect(cancellationToken, nullptr, this, nullptr);
+
     cancellationToken = token;
+
+    if (cancellationToken != nullptr)
+        QObject::connect(cancellationToken, &CancellationToken::cancelled, this, &DownloadQueue::cancelAll);
+}
+
+void DownloadQueue::setStreamScanner(std::function<QSharedPointer<HtmlStreamScanner>()> newScanner)
+{
+    this->newScanner = newScanner;
+}
+
+void DownloadQueue::setParallelDownloads(int parallelDownloads)
+{
+    this->parallelDownloads = parallelDownloads;
+
+    if (hasPendingJobs())
+        start();
+}
+
+void DownloadQueue::setMaxParallelDownloads(int maxParallelDownloads)
+{
+    this->maxParallelDownloads = maxParallelDownloads;
+
+    if (hasPendingJobs())
+        start();
+}
+
+int DownloadQueue::pendingCount(DownloadPriority priority) const
+{
+    return pendingJobs[priority].count();
+}
+
+int DownloadQueue::runningCount(DownloadPriority priority) const
+{
+    return std::count_if(running.begin(), running.end(),
+                         [priority](const RunningDownload& r) { return r.descriptor.priority == priority; });
+}
+
+QString DownloadQueue::diagnostics() const
+{
+    static const char* names[DownloadPriorityCount] = {"visible",         "forward", "backward",
+                                                       "chapterprefetch", "bulk",    "cover"};
+
+    QStringList parts;
+    for (int p = 0; p < DownloadPriorityCount; p++)
+        parts << QString("%1: %2/%3")
+                     .arg(names[p])
+                     .arg(runningCount((DownloadPriority)p))
+                     .arg(pendingCount((DownloadPriority)p));
+
+    auto result = "running/pending " + parts.join(", ");
+
+    QSet<QString> hosts;
+    for (const auto& r : running)
+        hosts.insert(r.host);
+    for (const auto& queue : pendingJobs)
+        for (const auto& descriptor : queue)
+            hosts.insert(hostOf(descriptor.url));
+
+    for (const auto& host : qAsConst(hosts))
+        result += QString("; %1: %2").arg(host, networkManager->connectionDiagnostics(host));
+
+    return result;
 }
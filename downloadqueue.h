@@ -1,6 +1,7 @@
 #ifndef DOWNLOADQUEUE_H
 #define DOWNLOADQUEUE_H
 
+#include "cancellationtoken.h"
 #include "networkmanager.h"
 
 enum DownloadType
@@ -9,13 +10,44 @@ enum DownloadType
     DownloadTypeScaledImage
 };
 
+// lower values are scheduled first
+enum DownloadPriority
+{
+    VisiblePagePriority = 0,
+    ForwardPreloadPriority,
+    BackwardPreloadPriority,
+    ChapterPrefetchPriority,
+    BulkDownloadPriority,
+    CoverPriority,
+    DownloadPriorityCount
+};
+
 struct FileDownloadDescriptor
 {
-    FileDownloadDescriptor(const QString &url, const QString &path) : url(url), path(path) {}
+    FileDownloadDescriptor(const QString &url, const QString &path,
+                           DownloadPriority priority = BulkDownloadPriority)
+        : url(url), path(path), priority(priority)
+    {
+    }
     QString url;
     QString path;
+    DownloadPriority priority;
+    QElapsedTimer queued;
+};
+
+struct RunningDownload
+{
+    FileDownloadDescriptor descriptor;
+    QSharedPointer<DownloadJobBase> job;
+    QString host;
+    QElapsedTimer timer;
 };
 
+// Runs downloads in priority order.
+// The number of parallel downloads is tuned per host by NetworkManager::adaptiveParallelism()
+// and shared by all queues, parallelDownloads is only the starting point for hosts that haven't
+// been measured yet. A queue may further cap its own downloads with setMaxParallelDownloads().
+
 class DownloadQueue : public QObject
 {
     Q_OBJECT
@@ -30,6 +62,7 @@ public:
     int totalJobs;
     int completed;
     int errors;
+    int cancelled;
     QString lastErrorMessage;
     bool cancelOnError;
 
@@ -37,9 +70,18 @@ public:
     void appendDownload(const FileDownloadDescriptor &urlAndPaths);
     void appendDownloads(const QList<FileDownloadDescriptor> &urlAndPaths);
     void clearQuene();
+    void cancelAll();
     void resetJobCount();
     bool awaitCompletion();
-    void setCancellationToken(bool *token);
+    void setCancellationToken(CancellationToken *token);
+    void setParallelDownloads(int parallelDownloads);
+    // 0 leaves it to the host limits
+    void setMaxParallelDownloads(int maxParallelDownloads);
+    void setStreamScanner(std::function<QSharedPointer<HtmlStreamScanner>()> newScanner);
+
+    int pendingCount(DownloadPriority priority) const;
+    int runningCount(DownloadPriority priority) const;
+    QString diagnostics() const;
 
 signals:
     void singleDownloadCompleted(const QString &url, const QString &path);
@@ -54,12 +96,22 @@ private:
 
     DownloadType type;
     int parallelDownloads;
-    QQueue<FileDownloadDescriptor> jobDescriptorQueue;
+    int maxParallelDownloads;
+    QVector<QQueue<FileDownloadDescriptor>> pendingJobs;
+    QList<RunningDownload> running;
     std::function<void(QSharedPointer<DownloadStringJob>)> lambda;
+    std::function<QSharedPointer<HtmlStreamScanner>()> newScanner;
     int individualTimeout;
-    bool *cancellationToken;
+    CancellationToken *cancellationToken;
 
-    void startSingle();
+    bool startSingle();
+    void startDescriptor(const FileDownloadDescriptor &descriptor);
+    bool hasPendingJobs() const;
+    int hostLimit(const QString &host);
+    bool promoteDuplicate(const FileDownloadDescriptor &descriptor);
+    void enqueue(const FileDownloadDescriptor &descriptor);
+    void preempt();
+    void detach(RunningDownload &download);
     void downloadFinished(QSharedPointer<DownloadJobBase> job, bool success);
 };
 
@@ -5,50 +5,31 @@
 DownloadStringJob::DownloadStringJob(QNetworkAccessManager *networkManager, const QString &url, int timeout,
                                      const QByteArray &postdata,
                                      const QList<std::tuple<const char *, const char *> > &customHeaders)
-    : DownloadBufferJob(networkManager, url, timeout, postdata, customHeaders), bufferStr("")
+    : DownloadBufferJob(networkManager, url, timeout, postdata, customHeaders), textCache(), textValid(false)
 {
 }
 
 void DownloadStringJob::restart()
 {
-    bufferStr = "";
+    textCache.clear();
+    textValid = false;
 
     DownloadBufferJob::restart();
 }
 
-void DownloadStringJob::downloadFinished()
+const QByteArray &DownloadStringJob::utf8() const
 {
-    timeoutTimer.stop();
-
-    QUrl redirect = reply->attribute(QNetworkRequest::RedirectionTargetAttribute).toUrl();
-    if (redirect.isValid())
-    {
-        if (redirect.host() != "")
-        {
-            this->url = redirect.toString();
-        }
-        else
-        {
-            QUrl base(this->url);
-            base.setPath(redirect.path());
-            this->url = base.toString();
-        }
-        this->restart();
-        return;
-    }
+    return buffer;
+}
 
-    if (errorString != "" || (reply->error() != QNetworkReply::NoError))
+const QString &DownloadStringJob::text()
+{
+    // the body is only final once the job completed, a partial one isn't kept
+    if (!textValid)
     {
-        // already handled
-        // emit downloadError();
+        textCache = QString::fromUtf8(buffer);
+        textValid = isCompleted;
     }
-    else
-    {
-        buffer = reply->readAll();
-        bufferStr = buffer;
 
-        isCompleted = true;
-
-        emit completed();
-    }
+    return textCache;
 }
@@ -7,18 +7,22 @@ class DownloadStringJob : public DownloadBufferJob
 {
     Q_OBJECT
 
-protected:
-    virtual void downloadFinished() override;
-
 public:
-    QString bufferStr;
-
     DownloadStringJob(QNetworkAccessManager *networkManager, const QString &url, int timeout = 6000,
                       const QByteArray &postData = QByteArray(),
                       const QList<std::tuple<const char *, const char *>> &customHeaders = {});
     virtual ~DownloadStringJob() = default;
 
+    // the body as received, without a copy
+    const QByteArray &utf8() const;
+    // the body decoded to a QString, only built on first use and kept until the job restarts
+    const QString &text();
+
     void restart() override;
+
+private:
+    QString textCache;
+    bool textValid;
 };
 
 #endif  // DOWNLOADFILEJOB_H
@@ -161,7 +161,7 @@ GreyscaleImage GreyscaleImage::crop(QRect rect)
     return GreyscaleImage(rect.size(), qMove(newBuffer));
 }
 
-bool GreyscaleImage::saveAsJpeg(const QString &path)
+QByteArray GreyscaleImage::encodeJpeg()
 {
     int outSubsamp = TJSAMP_GRAY, outQual = 85;
     int pixelFormat = TJPF_GRAY;
@@ -179,17 +179,26 @@ bool GreyscaleImage::saveAsJpeg(const QString &path)
 
     if (tjCompress2(tjInstanceC, (uchar *)buffer.data(), width, 0, height, pixelFormat, &newJpegBuf,
                     &newJpegSize, outSubsamp, outQual, flags) < 0)
-        return false;
+        return QByteArray();
 
     auto guard2 = qScopeGuard([&] {
         if (newJpegBuf)
             free(newJpegBuf);
     });
 
+    return QByteArray((const char *)newJpegBuf, newJpegSize);
+}
+
+bool GreyscaleImage::saveAsJpeg(const QString &path)
+{
+    auto jpeg = encodeJpeg();
+    if (jpeg.isEmpty())
+        return false;
+
     QFile file(path);
     if (!file.open(QIODevice::WriteOnly))
         return false;
-    file.write((char *)newJpegBuf, newJpegSize);
+    file.write(jpeg);
     file.close();
 
     return true;
@@ -43,6 +43,7 @@ public:
     GreyscaleImage rotate(int rotation);
     GreyscaleImage crop(QRect rect);
 
+    QByteArray encodeJpeg();
     bool saveAsJpeg(const QString &path);
 
     QImage toQImage();
@@ -0,0 +1,92 @@
+#include "htmlstreamscanner.h"
+
+#include <QTextCodec>
+
+HtmlStreamScanner::HtmlStreamScanner(const QString &startMarker, const QString &endMarker,
+                                     const QRegularExpression &entryrx)
+    : entries(),
+      startMarker(startMarker),
+      endMarker(endMarker),
+      entryrx(entryrx),
+      decoder(),
+      pending(),
+      started(false),
+      ended(false)
+{
+    reset();
+}
+
+void HtmlStreamScanner::reset()
+{
+    // multi-byte characters may be split between chunks, the decoder keeps the state
+    decoder.reset(QTextCodec::codecForName("UTF-8")->makeDecoder());
+    entries.clear();
+    pending.clear();
+    started = startMarker.isEmpty();
+    ended = false;
+}
+
+void HtmlStreamScanner::feed(const QByteArray &chunk)
+{
+    if (ended || chunk.isEmpty())
+        return;
+
+    pending.append(decoder->toUnicode(chunk));
+    scan(false);
+}
+
+void HtmlStreamScanner::finish()
+{
+    if (!ended)
+        scan(true);
+
+    pending.clear();
+}
+
+void HtmlStreamScanner::scan(bool final)
+{
+    if (!started)
+    {
+        int spos = pending.indexOf(startMarker);
+        if (spos < 0)
+        {
+            // the marker may be cut in two by the chunk boundary
+            pending.remove(0, qMax(0, pending.size() - startMarker.size() + 1));
+            return;
+        }
+
+        pending.remove(0, spos + startMarker.size());
+        started = true;
+    }
+
+    int limit = pending.size();
+    int epos = endMarker.isEmpty() ? -1 : pending.indexOf(endMarker);
+    if (epos >= 0)
+    {
+        limit = epos;
+        ended = true;
+    }
+
+    // matches ending close to the end of the received text might still grow with the next chunk
+    int safe = (ended || final) ? limit : limit - maxEntryLength;
+    int consumed = qMax(0, safe);
+
+    auto subject = pending.leftRef(limit);
+    auto rxit = entryrx.globalMatch(subject);
+    while (rxit.hasNext())
+    {
+        auto match = rxit.next();
+        if (match.capturedEnd() > safe)
+        {
+            consumed = qMin(consumed, match.capturedStart());
+            break;
+        }
+
+        entries.append({match.captured(1), match.captured(2)});
+    }
+
+    if (ended)
+        pending.clear();
+    else
+        pending.remove(0, consumed);
+}
@@ -0,0 +1,46 @@
+#ifndef HTMLSTREAMSCANNER_H
+#define HTMLSTREAMSCANNER_H
+
+#include <QRegularExpression>
+#include <QTextDecoder>
+
+struct HtmlScanEntry
+{
+    QString url;
+    QString title;
+};
+
+// Extracts the entries of a list page while it is downloaded.
+// The UTF-8 chunks are decoded one by one and searched for startMarker, from there on entryrx
+// (capturing the url first and the title second) is matched up to endMarker. Only the tail that
+// may still hold an incomplete entry is kept between chunks, so neither the whole page nor a list
+// of all matches is materialised. Empty markers stand for the begin and end of the page.
+class HtmlStreamScanner
+{
+public:
+    HtmlStreamScanner(const QString &startMarker, const QString &endMarker,
+                      const QRegularExpression &entryrx);
+
+    QList<HtmlScanEntry> entries;
+
+    void feed(const QByteArray &chunk);
+    void finish();
+    void reset();
+
+private:
+    // the longest an entry may get, matches closer than that to the end of a chunk wait for the next one
+    const int maxEntryLength = 2048;
+
+    QString startMarker;
+    QString endMarker;
+    QRegularExpression entryrx;
+
+    QScopedPointer<QTextDecoder> decoder;
+    QString pending;
+    bool started;
+    bool ended;
+
+    void scan(bool final);
+};
+
+#endif  // HTMLSTREAMSCANNER_H
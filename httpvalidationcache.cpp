@@ -0,0 +1,67 @@
+#include "httpvalidationcache.h"
+
+#include "staticsettings.h"
+
+HttpValidationCache::HttpValidationCache() {}
+
+QString HttpValidationCache::entryPath(const QString &url) const
+{
+    auto hash = QCryptographicHash::hash(url.toUtf8(), QCryptographicHash::Sha1).toHex();
+
+    return CONF.cacheDir + "httpcache/" + hash + ".dat";
+}
+
+bool HttpValidationCache::lookup(const QString &url, HttpValidationEntry &entry) const
+{
+    QFile file(entryPath(url));
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QString storedUrl;
+    QDataStream in(&file);
+    in >> storedUrl >> entry.etag >> entry.lastModified >> entry.body;
+    file.close();
+
+    return in.status() == QDataStream::Ok && storedUrl == url;
+}
+
+void HttpValidationCache::prepareRequest(const QString &url, QNetworkRequest &request) const
+{
+    HttpValidationEntry entry;
+    if (!lookup(url, entry))
+        return;
+
+    if (!entry.etag.isEmpty())
+        request.setRawHeader("If-None-Match", entry.etag);
+    if (!entry.lastModified.isEmpty())
+        request.setRawHeader("If-Modified-Since", entry.lastModified);
+}
+
+void HttpValidationCache::store(const QString &url, QNetworkReply *reply, const QByteArray &body)
+{
+    auto etag = reply->rawHeader("ETag");
+    auto lastModified = reply->rawHeader("Last-Modified");
+
+    // nothing to revalidate with next time
+    if (etag.isEmpty() && lastModified.isEmpty())
+    {
+        remove(url);
+        return;
+    }
+
+    auto path = entryPath(url);
+    QDir().mkpath(QFileInfo(path).path());
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+
+    QDataStream out(&file);
+    out << url << etag << lastModified << body;
+    file.close();
+}
+
+void HttpValidationCache::remove(const QString &url)
+{
+    QFile::remove(entryPath(url));
+}
@@ -0,0 +1,32 @@
+#ifndef HTTPVALIDATIONCACHE_H
+#define HTTPVALIDATIONCACHE_H
+
+#include <QNetworkReply>
+#include <QNetworkRequest>
+
+struct HttpValidationEntry
+{
+    QByteArray etag;
+    QByteArray lastModified;
+    QByteArray body;
+};
+
+// On-disk cache of response validators and bodies for conditional GETs.
+// Requests get If-None-Match/If-Modified-Since headers for a cached url,
+// a 304 reply is answered with the stored body.
+// Entries are stored in the cache dir, one file per url.
+class HttpValidationCache
+{
+public:
+    HttpValidationCache();
+
+    void prepareRequest(const QString &url, QNetworkRequest &request) const;
+    bool lookup(const QString &url, HttpValidationEntry &entry) const;
+    void store(const QString &url, QNetworkReply *reply, const QByteArray &body);
+    void remove(const QString &url);
+
+private:
+    QString entryPath(const QString &url) const;
+};
+
+#endif  // HTTPVALIDATIONCACHE_H
@@ -0,0 +1,168 @@
+#include "imageblobstore.h"
+
+#include <unistd.h>
+
+#include "staticsettings.h"
+
+ImageBlobStore::ImageBlobStore() : mutex(), urls(), blobs(), dirty(false)
+{
+    deserialize();
+}
+
+ImageBlobStore::~ImageBlobStore()
+{
+    serialize();
+}
+
+QByteArray ImageBlobStore::parametersKey(const ImageProcessingParameters &parameters,
+                                         const EncryptionDescriptor &encryption)
+{
+    return QString("%1x%2 %3 %4 %5 %6 %7:")
+               .arg(parameters.screenSize.width())
+               .arg(parameters.screenSize.height())
+               .arg(parameters.doublePageMode)
+               .arg(parameters.trim)
+               .arg(parameters.manhwaMode)
+               .arg(parameters.useSWDither)
+               .arg(encryption.type)
+               .toLatin1() +
+           encryption.key.toHex();
+}
+
+bool ImageBlobStore::hardLink(const QString &target, const QString &path)
+{
+    return ::link(QFile::encodeName(target).constData(), QFile::encodeName(path).constData()) == 0;
+}
+
+bool ImageBlobStore::restore(const QString &url, const QByteArray &parameters, const QString &path)
+{
+    QMutexLocker locker(&mutex);
+
+    auto key = url + "|" + parameters;
+
+    auto it = urls.find(key);
+    if (it == urls.end())
+        return false;
+
+    auto blob = blobs.find(it->value);
+    if (blob == blobs.end() || !QFile::exists(blob->value))
+    {
+        // the page holding the content was deleted
+        if (blob != blobs.end())
+            blobs.erase(blob);
+        urls.erase(it);
+        dirty = true;
+        return false;
+    }
+
+    if (blob->value == path)
+        return true;
+
+    QDir().mkpath(QFileInfo(path).path());
+    if (!hardLink(blob->value, path) && !QFile::copy(blob->value, path))
+        return false;
+
+    auto now = QDateTime::currentDateTimeUtc();
+    it->lastUsed = now;
+    blob->lastUsed = now;
+
+    return true;
+}
+
+void ImageBlobStore::store(const QString &url, const QByteArray &parameters, const QByteArray &source,
+                           const QString &path)
+{
+    QMutexLocker locker(&mutex);
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(source);
+    hash.addData(parameters);
+    QString contentKey = hash.result().toHex();
+
+    auto now = QDateTime::currentDateTimeUtc();
+
+    auto blob = blobs.find(contentKey);
+    if (blob != blobs.end() && blob->value != path && QFile::exists(blob->value))
+    {
+        // the same page under another url, credits and banners repeat in every chapter
+        auto linked = path + ".link";
+        QFile::remove(linked);
+        if (hardLink(blob->value, linked))
+        {
+            QFile::remove(path);
+            QFile::rename(linked, path);
+        }
+        blob->lastUsed = now;
+    }
+    else
+    {
+        blobs.insert(contentKey, {path, now});
+        evict(blobs, maxEntries);
+    }
+
+    urls.insert(url + "|" + parameters, {contentKey, now});
+    evict(urls, maxEntries);
+
+    dirty = true;
+}
+
+void ImageBlobStore::evict(QMap<QString, ImageBlobEntry> &entries, int maxEntries)
+{
+    while (entries.count() > maxEntries)
+    {
+        auto oldest = entries.begin();
+        for (auto it = entries.begin(); it != entries.end(); ++it)
+            if (it->lastUsed < oldest->lastUsed)
+                oldest = it;
+        entries.erase(oldest);
+    }
+}
+
+void ImageBlobStore::deserialize()
+{
+    QFile file(CONF.cacheDir + "imageblobs.dat");
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    QDataStream in(&file);
+
+    for (auto entries : {&urls, &blobs})
+    {
+        int count = 0;
+        in >> count;
+
+        for (int i = 0; i < count && in.status() == QDataStream::Ok; i++)
+        {
+            QString key;
+            ImageBlobEntry entry;
+            in >> key >> entry.value >> entry.lastUsed;
+
+            if (in.status() == QDataStream::Ok)
+                entries->insert(key, entry);
+        }
+    }
+    file.close();
+}
+
+void ImageBlobStore::serialize()
+{
+    QMutexLocker locker(&mutex);
+
+    if (!dirty)
+        return;
+
+    QFile file(CONF.cacheDir + "imageblobs.dat");
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+
+    QDataStream out(&file);
+    for (auto entries : {&urls, &blobs})
+    {
+        out << entries->count();
+        for (auto it = entries->begin(); it != entries->end(); ++it)
+            out << it.key() << it->value << it->lastUsed;
+    }
+    file.close();
+
+    dirty = false;
+}
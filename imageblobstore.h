@@ -0,0 +1,54 @@
+#ifndef IMAGEBLOBSTORE_H
+#define IMAGEBLOBSTORE_H
+
+#include <QDateTime>
+#include <QMap>
+#include <QMutex>
+
+#include "imageprocessingpipeline.h"
+
+struct ImageBlobEntry
+{
+    QString value;
+    QDateTime lastUsed;
+};
+
+// Content addressed index of the processed pages.
+// A page is known by the hash of its source bytes and the processing parameters, the first file
+// processed for it holds the content. Later pages with the same content become hard links to it
+// (where the file system supports them), pages whose url was processed before are restored from it
+// without downloading, decoding and scaling them again.
+// The index is kept in the cache dir, entries of deleted pages are dropped when they are hit.
+// Thread safe.
+class ImageBlobStore
+{
+public:
+    ImageBlobStore();
+    ~ImageBlobStore();
+
+    static QByteArray parametersKey(const ImageProcessingParameters &parameters,
+                                    const EncryptionDescriptor &encryption);
+
+    // creates the page at path from the content known for url, false if there is none
+    bool restore(const QString &url, const QByteArray &parameters, const QString &path);
+    // indexes the processed page at path
+    void store(const QString &url, const QByteArray &parameters, const QByteArray &source,
+               const QString &path);
+
+    void serialize();
+
+private:
+    const int maxEntries = 4096;
+
+    QMutex mutex;
+    QMap<QString, ImageBlobEntry> urls;   // url and parameters -> content hash
+    QMap<QString, ImageBlobEntry> blobs;  // content hash -> page file holding it
+    bool dirty;
+
+    static bool hardLink(const QString &target, const QString &path);
+    static void evict(QMap<QString, ImageBlobEntry> &entries, int maxEntries);
+
+    void deserialize();
+};
+
+#endif  // IMAGEBLOBSTORE_H
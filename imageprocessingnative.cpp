@@ -92,19 +92,19 @@ GreyscaleImage loadFromJpegAndRotate(const QByteArray &buffer, QSize screenSize,
     return img;
 }
 
-QImage processImageN(const QByteArray &buffer, const QString &filepath, QSize screenSize,
-                     DoublePageMode doublePageMode, bool trim, bool manhwaMode, bool useSWDither)
+GreyscaleImage decodeAndRotateImage(const QByteArray &buffer, QSize screenSize, DoublePageMode doublePageMode,
+                                    int &rot90)
 {
     GreyscaleImage img;
 
-    int rot90 = 0;
+    rot90 = 0;
 
     if (isPng(buffer))
     {
         img.loadFromPng(buffer);
 
         if (!img.isValid())
-            return QImage();
+            return GreyscaleImage();
 
         rot90 = calcRotationInfo(img.size(), screenSize, doublePageMode);
 
@@ -114,15 +114,14 @@ QImage processImageN(const QByteArray &buffer, const QString &filepath, QSize sc
     else if (isJpeg(buffer))
     {
         img = loadFromJpegAndRotate(buffer, screenSize, doublePageMode, rot90);
-
-        if (!img.isValid())
-            return QImage();
-    }
-    else
-    {
-        return QImage();
     }
 
+    return img;
+}
+
+GreyscaleImage trimAndRescaleImage(GreyscaleImage img, QSize screenSize, int rot90, bool trim,
+                                   bool manhwaMode)
+{
     if (trim)
     {
         auto trimRect = getTrimRect(img.buffer, img.width, img.height, img.width);
@@ -133,7 +132,20 @@ QImage processImageN(const QByteArray &buffer, const QString &filepath, QSize sc
 
     auto rescaleSize = calcRescaleSize(img.size(), screenSize, rot90 != 0, manhwaMode);
 
-    img = img.resize(rescaleSize);
+    return img.resize(rescaleSize);
+}
+
+QImage processImageN(const QByteArray &buffer, const QString &filepath, QSize screenSize,
+                     DoublePageMode doublePageMode, bool trim, bool manhwaMode, bool useSWDither)
+{
+    int rot90 = 0;
+
+    GreyscaleImage img = decodeAndRotateImage(buffer, screenSize, doublePageMode, rot90);
+
+    if (!img.isValid())
+        return QImage();
+
+    img = trimAndRescaleImage(img, screenSize, rot90, trim, manhwaMode);
 
     if (filepath != "")
         if (!img.saveAsJpeg(filepath))
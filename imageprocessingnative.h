@@ -15,6 +15,12 @@ QImage loadQImageFast(const QString &path, bool useSWDithering = true);
 GreyscaleImage loadFromJpegAndRotate(const QByteArray &buffer, QSize screenSize,
                                      DoublePageMode doublePageMode, int &rot90);
 
+GreyscaleImage decodeAndRotateImage(const QByteArray &buffer, QSize screenSize, DoublePageMode doublePageMode,
+                                    int &rot90);
+
+GreyscaleImage trimAndRescaleImage(GreyscaleImage img, QSize screenSize, int rot90, bool trim,
+                                   bool manhwaMode);
+
 QImage processImageN(const QByteArray &buffer, const QString &filepath, QSize screenSize,
                      DoublePageMode doublePageMode, bool trim, bool manhwaMode, bool useSWDither);
 
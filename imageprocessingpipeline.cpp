@@ -0,0 +1,269 @@
+#include "imageprocessingpipeline.h"
+
+#include <QSaveFile>
+
+#include "imageprocessingnative.h"
+#include "imageprocessingqt.h"
+#include "utils.h"
+
+ImageProcessingPipeline::ImageProcessingPipeline(QObject *parent)
+    : QObject(parent),
+      pendingInputBytes(0),
+      inputStalled(0),
+      inputQueue(-1),
+      decodeQueue(16),
+      transformQueue(2),
+      encodeQueue(2),
+      writeQueue(2),
+      stageThreads()
+{
+    // the jobs receive taskFinished() on the network thread
+    qRegisterMetaType<QSharedPointer<ImageProcessingTask>>();
+
+    stageThreads << QThread::create([this]() { decryptStage(); })
+                 << QThread::create([this]() { decodeStage(); })
+                 << QThread::create([this]() { transformStage(); })
+                 << QThread::create([this]() { encodeStage(); })
+                 << QThread::create([this]() { writeStage(); });
+
+    for (auto thread : qAsConst(stageThreads))
+        thread->start(QThread::LowPriority);
+}
+
+ImageProcessingPipeline::~ImageProcessingPipeline()
+{
+    inputQueue.close();
+    decodeQueue.close();
+    transformQueue.close();
+    encodeQueue.close();
+    writeQueue.close();
+
+    for (auto thread : qAsConst(stageThreads))
+    {
+        thread->wait();
+        delete thread;
+    }
+}
+
+bool ImageProcessingPipeline::acceptsInput()
+{
+    if (pendingInputBytes.loadAcquire() < maxPendingInputBytes)
+        return true;
+
+    inputStalled.storeRelease(1);
+    return false;
+}
+
+void ImageProcessingPipeline::feed(QSharedPointer<ImageProcessingTask> task, QByteArray &&data,
+                                   qint64 offset, bool last)
+{
+    pendingInputBytes.fetchAndAddOrdered(data.size());
+
+    ImageProcessingChunk chunk;
+    chunk.task = task;
+    chunk.data = std::move(data);
+    chunk.offset = offset;
+    chunk.last = last;
+
+    inputQueue.push(std::move(chunk));
+}
+
+void ImageProcessingPipeline::cancel(QSharedPointer<ImageProcessingTask> task)
+{
+    task->abort();
+
+    // drop the chunks that haven't reached a stage yet, the stages skip everything else of the task
+    qint64 released = 0;
+    inputQueue.removeIf([&](const ImageProcessingChunk &chunk) {
+        if (chunk.task != task)
+            return false;
+        released += chunk.data.size();
+        return true;
+    });
+    decodeQueue.removeIf([&](const ImageProcessingChunk &chunk) { return chunk.task == task; });
+
+    if (released > 0)
+        releaseInput(released);
+}
+
+void ImageProcessingPipeline::releaseInput(qint64 bytes)
+{
+    auto pending = pendingInputBytes.fetchAndSubOrdered(bytes) - bytes;
+
+    if (pending < maxPendingInputBytes / 2 && inputStalled.testAndSetOrdered(1, 0))
+        QMetaObject::invokeMethod(
+            this, [this]() { emit inputAvailable(); }, Qt::QueuedConnection);
+}
+
+void ImageProcessingPipeline::finishTask(QSharedPointer<ImageProcessingTask> task)
+{
+    if (task->isAborted())
+        return;
+
+    QMetaObject::invokeMethod(
+        this, [this, task]() { emit taskFinished(task); }, Qt::QueuedConnection);
+}
+
+void ImageProcessingPipeline::decryptStage()
+{
+    ImageProcessingChunk chunk;
+    while (inputQueue.pop(chunk))
+    {
+        qint64 size = chunk.data.size();
+        auto &encryption = chunk.task->encryption;
+
+        // an empty key leaves the data as it is
+        if (!chunk.task->isAborted() && encryption.type == XorEncryption && !encryption.key.isEmpty() &&
+            size > 0)
+        {
+            QElapsedTimer timer;
+            timer.start();
+
+            // rotate the key so that it lines up with the position of the chunk in the stream
+            int keyOffset = chunk.offset % encryption.key.length();
+            auto key = encryption.key.mid(keyOffset) + encryption.key.left(keyOffset);
+#ifdef KOBO
+            decryptXorInplace_NEON(chunk.data, key);
+#else
+            decryptXorInplace(chunk.data, key);
+#endif
+            chunk.task->decryptTime += timer.nsecsElapsed() / 1000;
+        }
+
+        if (!chunk.task->isAborted())
+            decodeQueue.push(std::move(chunk));
+
+        chunk = ImageProcessingChunk();
+        releaseInput(size);
+    }
+}
+
+void ImageProcessingPipeline::decodeStage()
+{
+    ImageProcessingChunk chunk;
+    while (decodeQueue.pop(chunk))
+    {
+        auto task = chunk.task;
+        chunk.task.clear();
+
+        if (task->isAborted())
+        {
+            task->decoder.clear();
+            task->encoded.clear();
+            continue;
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+
+        if (!task->decoder)
+            task->decoder.reset(new StreamingImageDecoder());
+
+        task->decoder->feed(chunk.data);
+
+        // the fast decoder can still fail after the header, the fallback then needs the whole source
+        task->encoded.append(chunk.data);
+        chunk.data.clear();
+
+        if (!chunk.last)
+        {
+            task->decodeTime += timer.nsecsElapsed() / 1000;
+            continue;
+        }
+
+        auto &parameters = task->parameters;
+
+        if (task->decoder->finish())
+        {
+            task->image = task->decoder->takeImage();
+            task->rot90 =
+                calcRotationInfo(task->image.size(), parameters.screenSize, parameters.doublePageMode);
+
+            if (task->rot90 != 0)
+                task->image = task->image.rotate(task->rot90);
+        }
+        task->decoder.clear();
+        task->decodeTime += timer.nsecsElapsed() / 1000;
+
+        if (!task->image.isValid())
+        {
+            qDebug() << "Fast decoding failed, using fallback!";
+
+            task->result = processImageQt(task->encoded, task->filepath, parameters.screenSize,
+                                          parameters.doublePageMode, parameters.trim, parameters.manhwaMode,
+                                          parameters.useSWDither);
+            task->encoded.clear();
+            finishTask(task);
+            continue;
+        }
+
+        task->encoded.clear();
+        transformQueue.push(std::move(task));
+    }
+}
+
+void ImageProcessingPipeline::transformStage()
+{
+    QSharedPointer<ImageProcessingTask> task;
+    while (transformQueue.pop(task))
+    {
+        if (!task->isAborted())
+        {
+            QElapsedTimer timer;
+            timer.start();
+
+            auto &parameters = task->parameters;
+            task->image = trimAndRescaleImage(task->image, parameters.screenSize, task->rot90,
+                                              parameters.trim, parameters.manhwaMode);
+            task->transformTime = timer.nsecsElapsed() / 1000;
+
+            encodeQueue.push(std::move(task));
+        }
+        task.clear();
+    }
+}
+
+void ImageProcessingPipeline::encodeStage()
+{
+    QSharedPointer<ImageProcessingTask> task;
+    while (encodeQueue.pop(task))
+    {
+        if (!task->isAborted())
+        {
+            QElapsedTimer timer;
+            timer.start();
+
+            task->jpeg = task->image.encodeJpeg();
+            task->encodeTime = timer.nsecsElapsed() / 1000;
+
+            writeQueue.push(std::move(task));
+        }
+        task.clear();
+    }
+}
+
+void ImageProcessingPipeline::writeStage()
+{
+    QSharedPointer<ImageProcessingTask> task;
+    while (writeQueue.pop(task))
+    {
+        if (!task->isAborted() && !task->jpeg.isEmpty())
+        {
+            // written aside and renamed over, the page may be a hard link shared with other pages
+            QSaveFile file(task->filepath);
+            if (file.open(QIODevice::WriteOnly) && file.write(task->jpeg) == task->jpeg.size() &&
+                file.commit())
+            {
+                if (task->parameters.useSWDither)
+                    task->image.dither();
+
+                task->result = task->image.toQImage();
+            }
+        }
+        task->jpeg.clear();
+        task->image = GreyscaleImage();
+
+        finishTask(task);
+        task.clear();
+    }
+}
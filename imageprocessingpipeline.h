@@ -0,0 +1,126 @@
+#ifndef IMAGEPROCESSINGPIPELINE_H
+#define IMAGEPROCESSINGPIPELINE_H
+
+#include <QAtomicInt>
+#include <QImage>
+#include <QObject>
+#include <QSharedPointer>
+#include <QThread>
+
+#include "boundedqueue.h"
+#include "enums.h"
+#include "greyscaleimage.h"
+#include "streamingimagedecoder.h"
+
+enum EncryptionType
+{
+    NoEncryption = 0,
+    XorEncryption
+};
+
+struct EncryptionDescriptor
+{
+    EncryptionType type = NoEncryption;
+    QByteArray key = {};
+};
+
+struct ImageProcessingParameters
+{
+    QSize screenSize;
+    DoublePageMode doublePageMode = DoublePageNoRotation;
+    bool trim = false;
+    bool manhwaMode = false;
+    bool useSWDither = false;
+};
+
+struct ImageProcessingTask
+{
+    ImageProcessingTask(const QString &filepath, const ImageProcessingParameters &parameters,
+                        const EncryptionDescriptor &encryption)
+        : filepath(filepath), parameters(parameters), encryption(encryption), aborted(0)
+    {
+    }
+
+    QString filepath;
+    ImageProcessingParameters parameters;
+    EncryptionDescriptor encryption;
+
+    // intermediate results, each stage releases what it doesn't need anymore
+    QSharedPointer<StreamingImageDecoder> decoder;
+    QByteArray encoded;  // for the fallback decoder, kept until decoding finished
+    GreyscaleImage image;
+    int rot90 = 0;
+    QByteArray jpeg;
+
+    QImage result;
+
+    // time spent in the stages in microseconds, each written by its stage thread only
+    qint64 decryptTime = 0;
+    qint64 decodeTime = 0;
+    qint64 transformTime = 0;
+    qint64 encodeTime = 0;
+
+    void abort() { aborted.storeRelease(1); }
+    bool isAborted() const { return aborted.loadAcquire() != 0; }
+
+private:
+    QAtomicInt aborted;
+};
+
+Q_DECLARE_METATYPE(QSharedPointer<ImageProcessingTask>)
+
+struct ImageProcessingChunk
+{
+    QSharedPointer<ImageProcessingTask> task;
+    QByteArray data;
+    qint64 offset = 0;
+    bool last = false;
+};
+
+// Processes downloaded images on worker threads:
+// (fetch) -> decrypt -> decode -> transform -> encode -> write
+// The decode stage decodes incrementally while chunks are still arriving.
+// Stages are connected by bounded queues. Input is accounted in bytes, when the stages fall behind
+// acceptsInput() returns false and the feeding jobs stop reading from the network until
+// inputAvailable() is emitted.
+class ImageProcessingPipeline : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ImageProcessingPipeline(QObject *parent = nullptr);
+    ~ImageProcessingPipeline();
+
+    bool acceptsInput();
+    void feed(QSharedPointer<ImageProcessingTask> task, QByteArray &&data, qint64 offset, bool last);
+    void cancel(QSharedPointer<ImageProcessingTask> task);
+
+signals:
+    void inputAvailable();
+    void taskFinished(QSharedPointer<ImageProcessingTask> task);
+
+private:
+    const qint64 maxPendingInputBytes = 4 * 1024 * 1024;
+
+    QAtomicInteger<qint64> pendingInputBytes;
+    QAtomicInt inputStalled;
+
+    BoundedQueue<ImageProcessingChunk> inputQueue;
+    BoundedQueue<ImageProcessingChunk> decodeQueue;
+    BoundedQueue<QSharedPointer<ImageProcessingTask>> transformQueue;
+    BoundedQueue<QSharedPointer<ImageProcessingTask>> encodeQueue;
+    BoundedQueue<QSharedPointer<ImageProcessingTask>> writeQueue;
+
+    QList<QThread *> stageThreads;
+
+    void decryptStage();
+    void decodeStage();
+    void transformStage();
+    void encodeStage();
+    void writeStage();
+
+    void releaseInput(qint64 bytes);
+    void finishTask(QSharedPointer<ImageProcessingTask> task);
+};
+
+#endif  // IMAGEPROCESSINGPIPELINE_H
@@ -0,0 +1,232 @@
+#include "jobfuture.h"
+
+#include "utils.h"
+
+JobFutureState::JobFutureState()
+    : QObject(), isResolved(false), succeeded(false), errorString(), jobs(), continuations(), self()
+{
+}
+
+void JobFutureState::resolve(bool success, const QString &error)
+{
+    if (isResolved)
+        return;
+
+    isResolved = true;
+    succeeded = success;
+    errorString = error;
+
+    for (const auto &job : qAsConst(jobs))
+        QObject::disconnect(job.get(), nullptr, this, nullptr);
+
+    auto pending = continuations;
+    continuations.clear();
+
+    for (const auto &continuation : pending)
+        continuation(succeeded, errorString);
+
+    emit resolved();
+
+    self.clear();
+}
+
+void JobFutureState::addContinuation(std::function<void(bool, const QString &)> continuation)
+{
+    if (isResolved)
+        continuation(succeeded, errorString);
+    else
+        continuations.append(continuation);
+}
+
+QSharedPointer<JobFutureState> JobFuture::newState()
+{
+    auto state = QSharedPointer<JobFutureState>(new JobFutureState(), &QObject::deleteLater);
+    state->self = state;
+
+    return state;
+}
+
+JobFuture::JobFuture(QSharedPointer<JobFutureState> state) : state(state) {}
+
+JobFuture::JobFuture(QSharedPointer<DownloadJobBase> job) : state(newState())
+{
+    state->jobs.append(job);
+
+    // isCompleted is set before the job stops running, so a stopped job that isn't completed failed
+    bool running = job->isRunning();
+
+    if (job->isCompleted)
+    {
+        state->resolve(true);
+    }
+    else if (!running)
+    {
+        state->resolve(false, job->errorString());
+    }
+    else
+    {
+        auto s = state.get();
+        QObject::connect(job.get(), &DownloadJobBase::completed, s, [s]() { s->resolve(true); });
+        QObject::connect(job.get(), &DownloadJobBase::downloadError, s,
+                         [s, job]() { s->resolve(false, job->errorString()); });
+    }
+}
+
+JobFuture JobFuture::resolved(bool success, const QString &error)
+{
+    auto state = newState();
+    state->resolve(success, error);
+
+    return JobFuture(state);
+}
+
+JobFuture JobFuture::all(const QList<JobFuture> &futures)
+{
+    auto state = newState();
+
+    if (futures.isEmpty())
+    {
+        state->resolve(true);
+        return JobFuture(state);
+    }
+
+    auto remaining = QSharedPointer<int>::create(futures.count());
+
+    for (const auto &future : futures)
+    {
+        state->jobs.append(future.state->jobs);
+        future.state->addContinuation([state, remaining](bool success, const QString &error) {
+            if (!success)
+                state->resolve(false, error);
+            else if (--*remaining == 0)
+                state->resolve(true);
+        });
+    }
+
+    return JobFuture(state);
+}
+
+JobFuture JobFuture::any(const QList<JobFuture> &futures)
+{
+    auto state = newState();
+
+    if (futures.isEmpty())
+    {
+        state->resolve(false, "Nothing to wait for.");
+        return JobFuture(state);
+    }
+
+    auto remaining = QSharedPointer<int>::create(futures.count());
+
+    for (const auto &future : futures)
+    {
+        state->jobs.append(future.state->jobs);
+        future.state->addContinuation([state, remaining](bool success, const QString &error) {
+            if (success)
+                state->resolve(true);
+            else if (--*remaining == 0)
+                state->resolve(false, error);
+        });
+    }
+
+    return JobFuture(state);
+}
+
+const JobFuture &JobFuture::then(std::function<void()> onSuccess) const
+{
+    state->addContinuation([onSuccess](bool success, const QString &) {
+        if (success)
+            onSuccess();
+    });
+
+    return *this;
+}
+
+const JobFuture &JobFuture::onFailure(std::function<void(const QString &)> onFailure) const
+{
+    state->addContinuation([onFailure](bool success, const QString &error) {
+        if (!success)
+            onFailure(error);
+    });
+
+    return *this;
+}
+
+const JobFuture &JobFuture::finally(std::function<void(bool)> continuation) const
+{
+    state->addContinuation([continuation](bool success, const QString &) { continuation(success); });
+
+    return *this;
+}
+
+JobFuture JobFuture::andThen(std::function<JobFuture()> next) const
+{
+    auto nextState = newState();
+    nextState->jobs = state->jobs;
+
+    state->addContinuation([nextState, next](bool success, const QString &error) {
+        if (!success)
+        {
+            nextState->resolve(false, error);
+            return;
+        }
+
+        auto future = next();
+        nextState->jobs.append(future.state->jobs);
+        future.state->addContinuation(
+            [nextState](bool success, const QString &error) { nextState->resolve(success, error); });
+    });
+
+    return JobFuture(nextState);
+}
+
+JobFuture JobFuture::timeout(int ms) const
+{
+    auto timedState = newState();
+    timedState->jobs = state->jobs;
+
+    state->addContinuation(
+        [timedState](bool success, const QString &error) { timedState->resolve(success, error); });
+
+    if (!timedState->isResolved)
+    {
+        auto s = timedState.get();
+        QTimer::singleShot(ms, s, [s]() { s->resolve(false, "Download timeout."); });
+    }
+
+    return JobFuture(timedState);
+}
+
+void JobFuture::cancel() const
+{
+    if (state->isResolved)
+        return;
+
+    for (const auto &job : qAsConst(state->jobs))
+        job->abort();
+
+    state->resolve(false, "Download cancelled.");
+}
+
+bool JobFuture::isResolved() const
+{
+    return state->isResolved;
+}
+
+bool JobFuture::isSucceeded() const
+{
+    return state->isResolved && state->succeeded;
+}
+
+QString JobFuture::errorString() const
+{
+    return state->errorString;
+}
+
+bool JobFuture::wait(int timeout) const
+{
+    if (!state->isResolved)
+        awaitSignal(state.get(), {SIGNAL(resolved())}, timeout);
+
+    return isSucceeded();
+}
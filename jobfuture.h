@@ -0,0 +1,72 @@
+#ifndef JOBFUTURE_H
+#define JOBFUTURE_H
+
+#include <functional>
+
+#include "downloadjobbase.h"
+
+class JobFutureState : public QObject
+{
+    Q_OBJECT
+
+public:
+    JobFutureState();
+
+    bool isResolved;
+    bool succeeded;
+    QString errorString;
+
+    // the jobs the outcome depends on, kept alive until it is known
+    QList<QSharedPointer<DownloadJobBase>> jobs;
+    QList<std::function<void(bool, const QString &)>> continuations;
+
+    // a pending state keeps itself alive, nobody has to hold the future
+    QSharedPointer<JobFutureState> self;
+
+    void resolve(bool success, const QString &error = "");
+    void addContinuation(std::function<void(bool, const QString &)> continuation);
+
+signals:
+    void resolved();
+};
+
+// Outcome of one or more download jobs.
+// Work is chained with continuations instead of waiting in nested event loops. A continuation runs
+// as soon as the outcome is known, right away if it already is.
+class JobFuture
+{
+public:
+    explicit JobFuture(QSharedPointer<DownloadJobBase> job);
+
+    static JobFuture resolved(bool success, const QString &error = "");
+    static JobFuture all(const QList<JobFuture> &futures);
+    static JobFuture any(const QList<JobFuture> &futures);
+
+    const JobFuture &then(std::function<void()> onSuccess) const;
+    const JobFuture &onFailure(std::function<void(const QString &)> onFailure) const;
+    const JobFuture &finally(std::function<void(bool)> continuation) const;
+
+    // continue with another asynchronous step once this one succeeded
+    JobFuture andThen(std::function<JobFuture()> next) const;
+    // fails after ms unless resolved before, the jobs keep running
+    JobFuture timeout(int ms) const;
+
+    // aborts the jobs and fails the future
+    void cancel() const;
+
+    bool isResolved() const;
+    bool isSucceeded() const;
+    QString errorString() const;
+
+    // for the remaining synchronous callers
+    bool wait(int timeout) const;
+
+private:
+    explicit JobFuture(QSharedPointer<JobFutureState> state);
+
+    static QSharedPointer<JobFutureState> newState();
+
+    QSharedPointer<JobFutureState> state;
+};
+
+#endif  // JOBFUTURE_H
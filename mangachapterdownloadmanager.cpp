@@ -22,7 +22,7 @@ void MangaChapterDownloadManager::cancelDownloads()
 {
     cancelled = true;
     running = false;
-    downloadQueue.clearQuene();
+    downloadQueue.cancelAll();
 }
 
 void MangaChapterDownloadManager::downloadQueueJobsCompleted()
@@ -48,23 +48,20 @@ void MangaChapterDownloadManager::processNextJob()
 
     for (int c = fromChapter; c <= toChapterInclusive && !cancelled; c++)
     {
-        // 3 trys
-        for (int i = 0; i < 3; i++)
-        {
-            auto res = mangaInfo->mangaSource->updatePageList(mangaInfo, c);
+        // transient network errors are already retried by the download jobs
+        auto res = mangaInfo->mangaSource->updatePageList(mangaInfo, c);
 
-            if (res.isOk())
-            {
-                emit downloadPagelistProgress(c + 1 - fromChapter, toChapterInclusive + 1 - fromChapter);
-                break;
-            }
-            else if (i > 2)
-            {
-                cancelled = true;
-                emit error(
-                    QString("Couldn't download pagelst for chapter %1: %2").arg(c + 1).arg(res.unwrapErr()));
-                return;
-            }
+        if (res.isOk())
+        {
+            emit downloadPagelistProgress(c + 1 - fromChapter, toChapterInclusive + 1 - fromChapter);
+        }
+        else
+        {
+            cancelled = true;
+            running = false;
+            emit error(
+                QString("Couldn't download pagelst for chapter %1: %2").arg(c + 1).arg(res.unwrapErr()));
+            return;
         }
     }
     mangaInfo->serialize();
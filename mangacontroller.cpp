@@ -1,13 +1,35 @@
 #include "mangacontroller.h"
 
-MangaController::MangaController(NetworkManager *networkManager, QObject *parent)
+MangaController::MangaController(NetworkManager *networkManager, RadioBurstScheduler *burstScheduler,
+                                 QObject *parent)
     : QObject(parent),
       currentIndex(nullptr, 0, 0),
       networkManager(networkManager),
+      burstScheduler(burstScheduler),
       preloadQueue(networkManager, {}, 1, false)
 {
     QObject::connect(&preloadQueue, &DownloadQueue::singleDownloadCompleted, this,
                      &MangaController::completedImagePreload);
+
+    // trickling preloads one by one would keep the radio up all the time
+    preloadQueue.setMaxParallelDownloads(1);
+    QObject::connect(burstScheduler, &RadioBurstScheduler::burstStarted, this, [this]() {
+        preloadQueue.setParallelDownloads(CONF.parallelDownloadsHigh);
+        preloadQueue.setMaxParallelDownloads(0);
+    });
+    QObject::connect(burstScheduler, &RadioBurstScheduler::burstFinished, this, [this]() {
+        preloadQueue.setParallelDownloads(1);
+        preloadQueue.setMaxParallelDownloads(1);
+    });
+
+    // without a connection the visible page can't be shown, say so instead of showing nothing
+    QObject::connect(burstScheduler, &RadioBurstScheduler::connectFailed, this, [this]() {
+        if (!this->burstScheduler->cancel("visible"))
+            return;
+
+        emit currentImageChanged("error");
+        emit error("Couldn't connect to WiFi.");
+    });
 }
 
 void MangaController::setCurrentManga(QSharedPointer<MangaInfo> mangaInfo)
@@ -72,6 +94,9 @@ Result<void, QString> MangaController::assurePagesLoaded()
 
 void MangaController::setCurrentIndex(const MangaIndex &index)
 {
+    // preloads around the old position would only delay the requested page
+    cancelAllPreloads();
+
     auto res = currentIndex.setChecked(index.chapter, index.page);
     if (res.isOk())
         currentIndexChangedInternal(true);
@@ -122,6 +147,20 @@ void MangaController::currentIndexChangedInternal(bool preload)
 
 void MangaController::updateCurrentImage()
 {
+    // pages outside of the last burst horizon wake the radio up
+    if (!networkManager->connected && !isPageCached(currentIndex.chapter, currentIndex.page))
+    {
+        auto manga = currentManga;
+        MangaIndex index = currentIndex;
+
+        burstScheduler->schedule("visible", [this, manga, index]() {
+            if (manga == currentManga && index == currentIndex)
+                updateCurrentImage();
+        });
+        burstScheduler->burst();
+        return;
+    }
+
     auto imageUrl = getImageUrl(currentIndex);
 
     if (!imageUrl.isOk())
@@ -134,17 +173,28 @@ void MangaController::updateCurrentImage()
     auto dd = DownloadImageDescriptor(imageUrl.unwrap(), currentManga->title, currentIndex.chapter,
                                       currentIndex.page);
 
-    auto imagePath = currentManga->mangaSource->downloadAwaitImage(dd);
-
-    if (imagePath.isOk())
-    {
-        emit currentImageChanged(imagePath.unwrap());
-    }
-    else
-    {
-        emit currentImageChanged("error");
-        emit error(imagePath.unwrapErr());
-    }
+    // let the visible page preempt running preloads instead of queueing behind them
+    auto path = currentManga->mangaSource->getImagePath(dd);
+    if (!QFile::exists(path))
+        preloadQueue.appendDownload(FileDownloadDescriptor(imageUrl.unwrap(), path, VisiblePagePriority));
+
+    // don't block the page turn, the image is shown once it is there or the error after 3 s
+    auto manga = currentManga;
+    MangaIndex index = currentIndex;
+
+    currentManga->mangaSource->downloadImageAsync(dd)
+        .timeout(3000)
+        .then([this, manga, index, path]() {
+            if (manga == currentManga && index == currentIndex)
+                emit currentImageChanged(path);
+        })
+        .onFailure([this, manga, index](const QString &errorString) {
+            if (manga != currentManga || index != currentIndex)
+                return;
+
+            emit currentImageChanged("error");
+            emit error(errorString);
+        });
 }
 
 void MangaController::advanceMangaPage(PageTurnDirection direction)
@@ -183,7 +233,7 @@ void MangaController::advanceMangaPage(PageTurnDirection direction)
         emit indexMovedOutOfBounds();
 }
 
-void MangaController::preloadImage(const MangaIndex &index)
+void MangaController::preloadImage(const MangaIndex &index, DownloadPriority priority)
 {
     auto imageUrl = getImageUrl(index);
 
@@ -201,7 +251,7 @@ void MangaController::preloadImage(const MangaIndex &index)
 
     //    qDebug() << "preload page" << index.page;
 
-    preloadQueue.appendDownload(FileDownloadDescriptor(imageUrl.unwrap(), path));
+    preloadQueue.appendDownload(FileDownloadDescriptor(imageUrl.unwrap(), path, priority));
 }
 
 void MangaController::preloadPopular()
@@ -210,52 +260,103 @@ void MangaController::preloadPopular()
         return;
 
     if (currentManga->chapters.count() > 1 && currentIndex.chapter != currentManga->chapters.count() - 1)
-        preloadImage({currentManga->chapters.count() - 1, 0});
+        preloadImage({currentManga->chapters.count() - 1, 0}, ChapterPrefetchPriority);
 }
 
 void MangaController::preloadNeighbours()
 {
-    int forward = CONF.forwardPreloads;
-    int backward = CONF.backwardPreloads;
+    // the reading horizon is fetched in one go while the radio is up,
+    // it is only woken up for it once the next pages are missing
+    auto manga = currentManga;
+    burstScheduler->schedule("horizon", [this, manga]() {
+        if (manga == currentManga)
+            preloadHorizon();
+    });
+
+    if (!networkManager->connected && !forwardPagesCached())
+        burstScheduler->burst();
+}
 
-    MangaIndexTraverser forwardindex(currentIndex);
+void MangaController::preloadHorizon()
+{
     MangaIndexTraverser backwardindex(currentIndex);
+    for (int i = 0; i < CONF.backwardPreloads; i++)
+    {
+        auto res = backwardindex.decrement();
+        if (!res.isOk())
+        {
+            emit error(res.unwrapErr());
+            break;
+        }
+
+        if (!res.unwrap())
+            break;
+
+        preloadImage(backwardindex, backwardindex.chapter == currentIndex.chapter ? BackwardPreloadPriority
+                                                                                  : ChapterPrefetchPriority);
+    }
+
+    // the rest of the current chapter and the next CONF.burstHorizonChapters chapters,
+    // queued nearest first
+    int lastChapter =
+        qMin(currentManga->chapters.count() - 1, currentIndex.chapter + CONF.burstHorizonChapters);
 
-    for (int i = 0; i < qMax(forward, backward); i++)
+    MangaIndexTraverser forwardindex(currentIndex);
+    while (forwardindex.chapter < lastChapter ||
+           forwardindex.page + 1 < forwardindex.currentChapter().pageUrlList.count())
     {
-        if (i < forward)
+        auto res = forwardindex.increment();
+        if (!res.isOk())
         {
-            auto res = forwardindex.increment();
-            if (res.isOk())
-            {
-                if (res.unwrap())
-                    preloadImage(forwardindex);
-            }
-            else
-            {
-                emit error(res.unwrapErr());
-            }
+            emit error(res.unwrapErr());
+            break;
         }
 
-        if (i < backward)
+        if (!res.unwrap())
+            break;
+
+        preloadImage(forwardindex, forwardindex.chapter == currentIndex.chapter ? ForwardPreloadPriority
+                                                                                : ChapterPrefetchPriority);
+    }
+}
+
+bool MangaController::isPageCached(int chapter, int page)
+{
+    auto &c = currentManga->chapters[chapter];
+    if (!c.pagesLoaded || page >= c.imageUrlList.count() || c.imageUrlList[page] == "")
+        return false;
+
+    DownloadImageDescriptor dd(c.imageUrlList[page], currentManga->title, chapter, page);
+
+    return QFile::exists(currentManga->mangaSource->getImagePath(dd));
+}
+
+bool MangaController::forwardPagesCached()
+{
+    int chapter = currentIndex.chapter;
+    int page = currentIndex.page;
+
+    for (int i = 0; i < CONF.forwardPreloads; i++)
+    {
+        if (++page >= currentManga->chapters[chapter].pageUrlList.count())
         {
-            auto res = forwardindex.decrement();
-            if (res.isOk())
-            {
-                if (res.unwrap())
-                    preloadImage(backwardindex);
-            }
-            else
-            {
-                emit error(res.unwrapErr());
-            }
+            if (chapter + 1 >= currentManga->chapters.count())
+                return true;
+
+            chapter++;
+            page = 0;
         }
+
+        if (!isPageCached(chapter, page))
+            return false;
     }
+
+    return true;
 }
 
 void MangaController::cancelAllPreloads()
 {
-    preloadQueue.clearQuene();
+    preloadQueue.cancelAll();
 }
 
 void MangaController::completedImagePreload(const QString &, const QString &path)
@@ -9,6 +9,7 @@
 #include "mangachapter.h"
 #include "mangaindextraverser.h"
 #include "mangainfo.h"
+#include "radioburstscheduler.h"
 #include "readingprogress.h"
 #include "staticsettings.h"
 #include "thirdparty/result.h"
@@ -18,7 +19,8 @@ class MangaController : public QObject
     Q_OBJECT
 
 public:
-    MangaController(NetworkManager *networkManager, QObject *parent = nullptr);
+    MangaController(NetworkManager *networkManager, RadioBurstScheduler *burstScheduler,
+                    QObject *parent = nullptr);
 
     QSharedPointer<MangaInfo> currentManga;
     MangaIndexTraverser currentIndex;
@@ -31,7 +33,7 @@ public:
     Result<QString, QString> getImageUrl(const MangaIndex &index);
 
     void preloadNeighbours();
-    void preloadImage(const MangaIndex &index);
+    void preloadImage(const MangaIndex &index, DownloadPriority priority);
 
     void preloadPopular();
     void cancelAllPreloads();
@@ -51,9 +53,13 @@ private:
     void currentIndexChangedInternal(bool preload);
     void chaptersMoved(QList<QPair<int, int>> moveMap);
     void updateCurrentImage();
+    void preloadHorizon();
+    bool isPageCached(int chapter, int page);
+    bool forwardPagesCached();
     void deserializeProgress();
     void serializeProgress();
     NetworkManager *networkManager;
+    RadioBurstScheduler *burstScheduler;
     DownloadQueue preloadQueue;
 };
 
@@ -51,7 +51,8 @@ QSharedPointer<DownloadFileJob> AbstractMangaSource::downloadImage(const Downloa
 {
     QString path = getImagePath(descriptor);
 
-    return networkManager->downloadAsScaledImage(descriptor.imageUrl, path);
+    return networkManager->downloadAsScaledImage(descriptor.imageUrl, path,
+                                                 getImageMirrorUrl(descriptor.imageUrl));
 }
 
 Result<QString, QString> AbstractMangaSource::downloadAwaitImage(const DownloadImageDescriptor &descriptor)
@@ -61,12 +62,18 @@ Result<QString, QString> AbstractMangaSource::downloadAwaitImage(const DownloadI
     if (QFile::exists(path))
         return Ok(path);
 
-    auto job = networkManager->downloadAsScaledImage(descriptor.imageUrl, path);
+    auto job = networkManager->downloadAsScaledImage(descriptor.imageUrl, path,
+                                                     getImageMirrorUrl(descriptor.imageUrl));
 
     if (job->await(3000))
         return Ok(path);
     else
-        return Err(job->errorString);
+        return Err(job->errorString());
+}
+
+JobFuture AbstractMangaSource::downloadImageAsync(const DownloadImageDescriptor &descriptor)
+{
+    return JobFuture(downloadImage(descriptor));
 }
 
 Result<QString, QString> AbstractMangaSource::getImageUrl(const QString &pageurl)
@@ -76,25 +83,69 @@ Result<QString, QString> AbstractMangaSource::getImageUrl(const QString &pageurl
     return Ok(pageurl);
 }
 
-Result<QSharedPointer<MangaInfo>, QString> AbstractMangaSource::loadMangaInfo(const QString &mangaUrl,
-                                                                              const QString &mangaTitle,
-                                                                              bool update)
+ImageVariant AbstractMangaSource::pickImageVariant() const
+{
+    if (imageVariants.isEmpty())
+        return ImageVariant();
+
+    // pages keep their aspect ratio, they are scaled down as long as one side is larger than the screen
+    auto target = networkManager->imageSize();
+    if (target.isEmpty())
+        return imageVariants.last();
+
+    for (const auto &variant : imageVariants)
+        if (variant.size.width() >= target.width() || variant.size.height() >= target.height())
+            return variant;
+
+    return imageVariants.last();
+}
+
+QString AbstractMangaSource::variantImageUrl(const QString &imageUrl, const ImageVariant &variant) const
+{
+    if (imageVariants.isEmpty() || variant.name == imageVariants.last().name)
+        return imageUrl;
+
+    auto original = imageVariants.last().size;
+    double area = double(variant.size.width()) * variant.size.height() /
+                  (double(original.width()) * original.height());
+
+    return imageUrl + "|area:" + QString::number(area, 'f', 3);
+}
+
+QString AbstractMangaSource::getImageMirrorUrl(const QString &)
+{
+    // Default implementation:
+    // no mirror, stalled requests are duplicated to the same url
+    return QString();
+}
+
+QSharedPointer<MangaInfo> AbstractMangaSource::loadStoredMangaInfo(const QString &mangaTitle, bool update)
 {
     QString path(CONF.mangainfodir(name, mangaTitle) + "mangainfo.dat");
-    if (QFile::exists(path))
+    if (!QFile::exists(path))
+        return QSharedPointer<MangaInfo>();
+
+    try
     {
-        try
-        {
-            auto info = MangaInfo::deserialize(this, path);
-            if (update)
-                info->mangaSource->updateMangaInfoAsync(info);
+        auto info = MangaInfo::deserialize(this, path);
+        if (update)
+            info->mangaSource->updateMangaInfoAsync(info);
 
-            return Ok(info);
-        }
-        catch (QException &)
-        {
-        }
+        return info;
     }
+    catch (QException &)
+    {
+        return QSharedPointer<MangaInfo>();
+    }
+}
+
+Result<QSharedPointer<MangaInfo>, QString> AbstractMangaSource::loadMangaInfo(const QString &mangaUrl,
+                                                                              const QString &mangaTitle,
+                                                                              bool update)
+{
+    auto info = loadStoredMangaInfo(mangaTitle, update);
+    if (info)
+        return Ok(info);
 
     auto infoR = getMangaInfo(mangaUrl, mangaTitle);
 
@@ -104,11 +155,9 @@ Result<QSharedPointer<MangaInfo>, QString> AbstractMangaSource::loadMangaInfo(co
     return infoR;
 }
 
-Result<QSharedPointer<MangaInfo>, QString> AbstractMangaSource::getMangaInfo(const QString &mangaUrl,
-                                                                             const QString &mangaTitle)
+QSharedPointer<MangaInfo> AbstractMangaSource::newMangaInfo(const QString &mangaUrl,
+                                                           const QString &mangaTitle)
 {
-    auto job = networkManager->downloadAsString(mangaUrl, 2000, mangaInfoPostDataStr);
-
     auto info = QSharedPointer<MangaInfo>(new MangaInfo(this));
 
     info->mangaSource = this;
@@ -116,10 +165,14 @@ Result<QSharedPointer<MangaInfo>, QString> AbstractMangaSource::getMangaInfo(con
     info->url = mangaUrl;
     info->title = mangaTitle;
 
-    if (!job->await(2000))
-        return Err(job->errorString);
+    return info;
+}
 
+Result<void, QString> AbstractMangaSource::mergeMangaInfo(QSharedPointer<DownloadStringJob> job,
+                                                          QSharedPointer<MangaInfo> info)
+{
     int oldnumchapters = info->chapters.count();
+
     auto res = updateMangaInfoFinishedLoading(job, info);
     if (res.isErr())
         return Err(res.unwrapErr());
@@ -136,43 +189,79 @@ Result<QSharedPointer<MangaInfo>, QString> AbstractMangaSource::getMangaInfo(con
 
     info->updateCompeted(info->chapters.count() > oldnumchapters, moveMapping);
 
+    return Ok();
+}
+
+Result<QSharedPointer<MangaInfo>, QString> AbstractMangaSource::getMangaInfo(const QString &mangaUrl,
+                                                                             const QString &mangaTitle)
+{
+    auto job = networkManager->downloadAsString(mangaUrl, 2000, mangaInfoPostDataStr, true);
+
+    auto info = newMangaInfo(mangaUrl, mangaTitle);
+
+    if (!job->await(2000))
+        return Err(job->errorString());
+
+    auto res = mergeMangaInfo(job, info);
+    if (res.isErr())
+        return Err(res.unwrapErr());
+
     downloadCoverAsync(info);
 
     return Ok(info);
 }
 
-void AbstractMangaSource::updateMangaInfoAsync(QSharedPointer<MangaInfo> info, bool updateCover)
+JobFuture AbstractMangaSource::getMangaInfoAsync(const QString &mangaUrl, const QString &mangaTitle,
+                                                 std::function<void(QSharedPointer<MangaInfo>)> onLoaded)
 {
-    int oldnumchapters = info->chapters.count();
+    auto job = networkManager->downloadAsString(mangaUrl, 2000, mangaInfoPostDataStr, true);
 
-    auto job = networkManager->downloadAsString(info->url, 2000, mangaInfoPostDataStr);
+    auto info = newMangaInfo(mangaUrl, mangaTitle);
 
-    auto lambda = [oldnumchapters, info, job, updateCover, this]
-    {
+    return JobFuture(job).andThen([this, job, info, onLoaded]() {
+        auto res = mergeMangaInfo(job, info);
+        if (res.isErr())
+            return JobFuture::resolved(false, res.unwrapErr());
+
+        info->serialize();
+        downloadCoverAsync(info);
+        onLoaded(info);
+
+        return JobFuture::resolved(true);
+    });
+}
+
+JobFuture AbstractMangaSource::loadMangaInfoAsync(const QString &mangaUrl, const QString &mangaTitle,
+                                                  std::function<void(QSharedPointer<MangaInfo>)> onLoaded)
+{
+    auto info = loadStoredMangaInfo(mangaTitle, true);
+    if (!info)
+        return getMangaInfoAsync(mangaUrl, mangaTitle, onLoaded);
+
+    onLoaded(info);
+
+    return JobFuture::resolved(true);
+}
+
+void AbstractMangaSource::updateMangaInfoAsync(QSharedPointer<MangaInfo> info, bool updateCover)
+{
+    auto job = networkManager->downloadAsString(info->url, 2000, mangaInfoPostDataStr, true);
+
+    JobFuture(job).then([info, job, updateCover, this]() {
+        // page unchanged since the last update, nothing to parse or merge
+        if (job->notModified && info->chapters.count() > 0)
         {
-            //            QMutexLocker locker(info->updateMutex.get());
-            auto res = updateMangaInfoFinishedLoading(job, info);
-            if (res.isErr())
-                return;
-
-            auto newChapters = res.unwrap();
-
-            auto moveMapping = info->chapters.mergeChapters(newChapters);
-            if (!moveMapping.empty())
-            {
-                info->updated = true;
-                reorderChapterPages(info, moveMapping);
-            };
-
-            bool newchapters = info->chapters.count() > oldnumchapters;
-            info->updateCompeted(newchapters, moveMapping);
+            info->updateCompeted(false, {});
+            downloadCoverAsync(info, updateCover);
+            return;
         }
 
+        if (mergeMangaInfo(job, info).isErr())
+            return;
+
         downloadCoverAsync(info, updateCover);
         info->serialize();
-    };
-
-    executeOnJobCompletion(job, lambda);
+    });
 }
 
 Result<void, QString> AbstractMangaSource::updatePageList(QSharedPointer<MangaInfo> info, int chapter)
@@ -287,18 +376,80 @@ void AbstractMangaSource::downloadCoverAsync(QSharedPointer<MangaInfo> mangainfo
 
     auto coverjob = networkManager->downloadAsFile(mangainfo->coverUrl, mangainfo->coverPath);
 
-    auto lambda = [this, mangainfo]()
-    {
+    JobFuture(coverjob).then([this, mangainfo]() {
         generateCoverThumbnail(mangainfo);
         mangainfo->sendCoverLoaded();
-    };
+    });
+}
+
+// decodes the entities of a text without markup, returns a null string for entities it doesn't know
+static QString decodeHtmlEntities(const QStringRef &str)
+{
+    static const QHash<QString, QChar> named = {{"amp", '&'},  {"lt", '<'},   {"gt", '>'},
+                                               {"quot", '"'}, {"apos", '\''}, {"nbsp", ' '}};
+
+    QString text;
+    text.reserve(str.size());
 
-    executeOnJobCompletion(coverjob, lambda);
+    int pos = 0;
+    while (pos < str.size())
+    {
+        int amp = str.indexOf('&', pos);
+        if (amp < 0)
+            amp = str.size();
+        text.append(str.mid(pos, amp - pos));
+        if (amp == str.size())
+            break;
+
+        int semicolon = str.indexOf(';', amp);
+        if (semicolon < 0 || semicolon - amp > 10)
+            return QString();
+
+        auto entity = str.mid(amp + 1, semicolon - amp - 1);
+        bool ok = false;
+        if (entity.startsWith("#x") || entity.startsWith("#X"))
+        {
+            uint code = entity.mid(2).toUInt(&ok, 16);
+            if (ok)
+                text.append(QString::fromUcs4(&code, 1));
+        }
+        else if (entity.startsWith('#'))
+        {
+            uint code = entity.mid(1).toUInt(&ok, 10);
+            if (ok)
+                text.append(QString::fromUcs4(&code, 1));
+        }
+        else if (named.contains(entity.toString()))
+        {
+            text.append(named[entity.toString()]);
+            ok = true;
+        }
+
+        if (!ok)
+            return QString();
+
+        pos = semicolon + 1;
+    }
+
+    return text;
 }
 
 QString AbstractMangaSource::htmlToPlainText(const QString &str)
 {
-    htmlConverter.setHtml(str);
+    return htmlToPlainText(QStringRef(&str));
+}
+
+QString AbstractMangaSource::htmlToPlainText(const QStringRef &str)
+{
+    // most captures are plain text with a few entities, laying out a document is only needed for markup
+    if (!str.contains('<'))
+    {
+        auto text = decodeHtmlEntities(str);
+        if (!text.isNull())
+            return text.simplified();
+    }
+
+    htmlConverter.setHtml(str.toString());
     return htmlConverter.toPlainText();
 }
 
@@ -321,22 +472,22 @@ void AbstractMangaSource::fillMangaInfo(QSharedPointer<MangaInfo> info, const QS
     QRegularExpression bbrx(R"(\[.*?\])");
 
     if (authorrxmatch.hasMatch())
-        info->author = htmlToPlainText(authorrxmatch.captured(1)).remove('\n');
+        info->author = htmlToPlainText(authorrxmatch.capturedRef(1)).remove('\n');
     if (artistrxmatch.hasMatch())
-        info->artist = htmlToPlainText(artistrxmatch.captured(1)).remove('\n');
+        info->artist = htmlToPlainText(artistrxmatch.capturedRef(1)).remove('\n');
     if (statusrxmatch.hasMatch())
-        info->status = htmlToPlainText(statusrxmatch.captured(1));
+        info->status = htmlToPlainText(statusrxmatch.capturedRef(1));
     if (yearrxmatch.hasMatch())
-        info->releaseYear = htmlToPlainText(yearrxmatch.captured(1));
+        info->releaseYear = htmlToPlainText(yearrxmatch.capturedRef(1));
     if (genresrxmatch.hasMatch())
-        info->genres = htmlToPlainText(genresrxmatch.captured(1))
+        info->genres = htmlToPlainText(genresrxmatch.capturedRef(1))
                            .trimmed()
                            .remove('\n')
                            .replace(", ", " ")
                            .replace("/ ", " ")
                            .replace(",", " ");
     if (summaryrxmatch.hasMatch())
-        info->summary = htmlToPlainText(summaryrxmatch.captured(1)).remove(bbrx);
+        info->summary = htmlToPlainText(summaryrxmatch.capturedRef(1)).remove(bbrx);
     if (coverrxmatch.hasMatch())
         info->coverUrl = coverrxmatch.captured(1);
 }
@@ -8,6 +8,7 @@
 
 #include "downloadimagedescriptor.h"
 #include "downloadqueue.h"
+#include "jobfuture.h"
 #include "mangachaptercollection.h"
 #include "mangalist.h"
 #include "networkmanager.h"
@@ -18,6 +19,12 @@
 
 class MangaInfo;
 
+struct ImageVariant
+{
+    QString name;
+    QSize size;  // typical page size
+};
+
 class AbstractMangaSource
 {
 public:
@@ -40,9 +47,18 @@ public:
 
     virtual Result<QStringList, QString> getPageList(const QString &chapterUrl) = 0;
     virtual Result<QString, QString> getImageUrl(const QString &pageUrl);
+    // another location of the same image, stalled image requests are duplicated to it
+    virtual QString getImageMirrorUrl(const QString &imageUrl);
+
+    // non-blocking variant of getMangaInfo, onLoaded is called before the future succeeds
+    JobFuture getMangaInfoAsync(const QString &mangaUrl, const QString &mangaTitle,
+                                std::function<void(QSharedPointer<MangaInfo>)> onLoaded);
 
     Result<QSharedPointer<MangaInfo>, QString> loadMangaInfo(const QString &mangaUrl,
                                                              const QString &mangatitle, bool update = true);
+    // non-blocking variant of loadMangaInfo, a stored info is passed to onLoaded right away
+    JobFuture loadMangaInfoAsync(const QString &mangaUrl, const QString &mangaTitle,
+                                 std::function<void(QSharedPointer<MangaInfo>)> onLoaded);
 
     bool serializeMangaList();
     bool deserializeMangaList();
@@ -52,8 +68,10 @@ public:
     QSharedPointer<DownloadFileJob> downloadImage(const DownloadImageDescriptor &descriptor);
 
     Result<QString, QString> downloadAwaitImage(const DownloadImageDescriptor &descriptor);
+    JobFuture downloadImageAsync(const DownloadImageDescriptor &descriptor);
 
     QString htmlToPlainText(const QString &str);
+    QString htmlToPlainText(const QStringRef &str);
 
     virtual void updateMangaInfoAsync(QSharedPointer<MangaInfo> mangainfo, bool updateCover = true);
     void downloadCoverAsync(QSharedPointer<MangaInfo> mangainfo, bool updateCover = true);
@@ -64,10 +82,22 @@ public:
 protected:
     QByteArray mangaInfoPostDataStr;
 
+    // the page sizes a source can download, smallest first, the last one is the original
+    QList<ImageVariant> imageVariants;
+
+    // the smallest variant that still covers the screen, the pages are scaled down to it anyway
+    ImageVariant pickImageVariant() const;
+    // tags a page url with the share of the original pixels, for estimating the bytes saved
+    QString variantImageUrl(const QString &imageUrl, const ImageVariant &variant) const;
+
     NetworkManager *networkManager;
     QTextDocument htmlConverter;
 
     void generateCoverThumbnail(QSharedPointer<MangaInfo> mangainfo);
+    QSharedPointer<MangaInfo> newMangaInfo(const QString &mangaUrl, const QString &mangaTitle);
+    QSharedPointer<MangaInfo> loadStoredMangaInfo(const QString &mangaTitle, bool update);
+    Result<void, QString> mergeMangaInfo(QSharedPointer<DownloadStringJob> job,
+                                         QSharedPointer<MangaInfo> info);
     void fillMangaInfo(QSharedPointer<MangaInfo> info, const QString &buffer,
                        const QRegularExpression &authorrx, const QRegularExpression &artistrx,
                        const QRegularExpression &statusrx, const QRegularExpression &yearrx,
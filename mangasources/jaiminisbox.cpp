@@ -25,7 +25,7 @@ bool JaiminisBox::uptareMangaList(UpdateProgressToken *token)
 
     if (!job->await(7000))
     {
-        token->sendError(job->errorString);
+        token->sendError(job->errorString());
         return false;
     }
 
@@ -65,7 +65,7 @@ bool JaiminisBox::uptareMangaList(UpdateProgressToken *token)
         urls.append(dictionaryUrl + QString::number(i));
 
     DownloadQueue queue(networkManager, urls, CONF.parallelDownloadsLow, lambda, true);
-    queue.setCancellationToken(&token->canceled);
+    queue.setCancellationToken(&token->cancellation);
     queue.start();
     if (!queue.awaitCompletion())
     {
@@ -113,7 +113,7 @@ Result<QStringList, QString> JaiminisBox::getPageList(const QString &chapterUrl)
     auto job = networkManager->downloadAsString(chapterUrl, 8000, mangaInfoPostDataStr);
 
     if (!job->await(8000))
-        return Err(job->errorString);
+        return Err(job->errorString());
 
     auto rxmatch = encodedrx.match(job->buffer);
     if (!rxmatch.hasMatch())
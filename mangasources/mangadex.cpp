@@ -12,6 +12,15 @@ MangaDex::MangaDex(NetworkManager *dm) : AbstractMangaSource(dm)
     networkManager->addCookie(".mangadex.org", "mangadex_title_mode", "2");
     networkManager->addCookie(".mangadex.org", "mangadex_filter_langs", "1");
 
+    // at-home image servers multiplex all pages of a chapter over one connection
+    networkManager->setHostConnectionPolicy(".mangadex.network", HostConnectionPolicy(true));
+    networkManager->setHostConnectionPolicy("api.mangadex.org", HostConnectionPolicy(true, 2));
+    // the api allows about 5 requests per second and client
+    networkManager->setHostRateLimit("api.mangadex.org", RateLimit(5, 5));
+
+    // data-saver pages are recompressed and smaller, approximate sizes
+    imageVariants = {{"data-saver", QSize(800, 1150)}, {"data", QSize(1400, 2000)}};
+
     statuses = {"Ongoing", "Completed", "Cancelled", "Hiatus"};
     demographies = {"Shounen", "Shoujo", "Seinen", "Josei"};
     genreMap.insert(2, "Action");
@@ -72,7 +81,7 @@ bool MangaDex::updateMangaList(UpdateProgressToken *token)
 
                 if (!job->await(7000))
                 {
-                    token->sendError(job->errorString);
+                    token->sendError(job->errorString());
                     return false;
                 }
 
@@ -186,7 +195,7 @@ Result<MangaChapterCollection, QString> MangaDex::updateMangaInfoFinishedLoading
         auto jobChapter = networkManager->downloadAsString("https://api.mangadex.org/chapter?manga=" + id + "&limit=100", -1);
         if (!jobChapter->await(3000))
         {
-            return Err(jobChapter->errorString);
+            return Err(jobChapter->errorString());
         }
 
         chDoc.Parse(jobChapter->buffer.data());
@@ -198,7 +207,7 @@ Result<MangaChapterCollection, QString> MangaDex::updateMangaInfoFinishedLoading
             jobChapter = networkManager->downloadAsString("https://api.mangadex.org/chapter?manga=" + id + "&includes[]=scanlation_group&limit=100&offset=" + offset, -1);
             if (!jobChapter->await(3000))
             {
-                return Err(jobChapter->errorString);
+                return Err(jobChapter->errorString());
             }
 
             chDoc.Parse(jobChapter->buffer.data());
@@ -273,7 +282,7 @@ Result<QStringList, QString> MangaDex::getPageList(const QString &chapterUrl)
     auto job = networkManager->downloadAsString(chapterUrl);
 
     if (!job->await(7000))
-        return Err(job->errorString);
+        return Err(job->errorString());
 
     QStringList imageUrls;
 
@@ -284,11 +293,16 @@ Result<QStringList, QString> MangaDex::getPageList(const QString &chapterUrl)
         if (!res)
             return Err(QString("Coulnd't parse pagelist.1"));
 
-        auto hash = QString(doc["data"]["attributes"]["hash"].GetString());
-        auto server = QString("https://uploads.mangadex.org/data/");
-        auto pagesArray = doc["data"]["attributes"]["data"].GetArray();
+        auto variant = pickImageVariant();
+        auto &attributes = doc["data"]["attributes"];
+        if (variant.name == "data-saver" && !attributes.HasMember("dataSaver"))
+            variant = imageVariants.last();
+
+        auto hash = QString(attributes["hash"].GetString());
+        auto server = QString("https://uploads.mangadex.org/%1/").arg(variant.name);
+        auto pagesArray = attributes[variant.name == "data-saver" ? "dataSaver" : "data"].GetArray();
         for (const auto &page : pagesArray)
-            imageUrls.append(server + hash + "/" + page.GetString());
+            imageUrls.append(variantImageUrl(server + hash + "/" + page.GetString(), variant));
     }
     catch (QException &)
     {
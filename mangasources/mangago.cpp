@@ -19,7 +19,7 @@ bool MangaGo::updateMangaList(UpdateProgressToken *token)
 
     if (!job->await(7000))
     {
-        token->sendError(job->errorString);
+        token->sendError(job->errorString());
         return false;
     }
 
@@ -28,8 +28,8 @@ bool MangaGo::updateMangaList(UpdateProgressToken *token)
     QElapsedTimer timer;
     timer.start();
 
-    auto numpagesrxmatch = numpagesrx.match(job->bufferStr);
-    auto nummangasrxmatch = nummangasrx.match(job->bufferStr);
+    auto numpagesrxmatch = numpagesrx.match(job->text());
+    auto nummangasrxmatch = nummangasrx.match(job->text());
 
     int pages = 1;
     if (numpagesrxmatch.hasMatch())
@@ -47,7 +47,7 @@ bool MangaGo::updateMangaList(UpdateProgressToken *token)
     const int matchesPerPage = 44;
     auto lambda = [&](QSharedPointer<DownloadStringJob> job) {
         int matches = 0;
-        for (auto &match : getAllRxMatches(mangarx, job->bufferStr))
+        for (auto &match : getAllRxMatches(mangarx, job->text()))
         {
             auto title = htmlToPlainText(match.captured(2));
             auto url = match.captured(1);
@@ -72,7 +72,7 @@ bool MangaGo::updateMangaList(UpdateProgressToken *token)
         urls.append(mangalistUrl + QString::number(i));
 
     DownloadQueue queue(networkManager, urls, CONF.parallelDownloadsHigh, lambda, true);
-    queue.setCancellationToken(&token->canceled);
+    queue.setCancellationToken(&token->cancellation);
     queue.start();
     if (!queue.awaitCompletion())
     {
@@ -107,13 +107,13 @@ Result<MangaChapterCollection, QString> MangaGo::updateMangaInfoFinishedLoading(
     QRegularExpression chapterrx(R"lit(<a[^>]*href="([^"]*)">W*(.*?)W*</a>)lit",
                                  QRegularExpression::DotMatchesEverythingOption);
 
-    fillMangaInfo(info, job->bufferStr, authorrx, artistrx, statusrx, yearrx, genresrx, summaryrx, coverrx);
+    fillMangaInfo(info, job->text(), authorrx, artistrx, statusrx, yearrx, genresrx, summaryrx, coverrx);
 
-    int spos = job->bufferStr.indexOf(R"(id="chapter_table">)");
-    int epos = job->bufferStr.indexOf(R"(</table>)", spos);
+    int spos = job->text().indexOf(R"(id="chapter_table">)");
+    int epos = job->text().indexOf(R"(</table>)", spos);
 
     MangaChapterCollection newchapters;
-    for (auto &chapterrxmatch : getAllRxMatches(chapterrx, job->bufferStr, spos, epos))
+    for (auto &chapterrxmatch : getAllRxMatches(chapterrx, job->text(), spos, epos))
         newchapters.insert(
             0, MangaChapter(htmlToPlainText(chapterrxmatch.captured(2)), chapterrxmatch.captured(1)));
 
@@ -128,10 +128,10 @@ Result<QStringList, QString> MangaGo::getPageList(const QString &chapterUrl)
     auto job = networkManager->downloadAsString(chapterUrl);
 
     if (!job->await(7000))
-        return Err(job->errorString);
+        return Err(job->errorString());
 
     QStringList imageUrls;
-    for (auto &match : getAllRxMatches(pagerx, job->bufferStr))
+    for (auto &match : getAllRxMatches(pagerx, job->text()))
     {
         imageUrls.append(match.captured(1));
     }
@@ -19,7 +19,7 @@ bool MangaHere::updateMangaList(UpdateProgressToken *token)
 
     if (!job->await())
     {
-        token->sendError(job->errorString);
+        token->sendError(job->errorString());
         return false;
     }
 
@@ -28,7 +28,7 @@ bool MangaHere::updateMangaList(UpdateProgressToken *token)
     QElapsedTimer timer;
     timer.start();
 
-    auto numpagesrxmatch = numpagesrx.match(job->bufferStr);
+    auto numpagesrxmatch = numpagesrx.match(job->text());
 
     MangaList mangas;
     mangas.absoluteUrls = false;
@@ -42,7 +42,7 @@ bool MangaHere::updateMangaList(UpdateProgressToken *token)
     const int matchesPerPage = 70;
     auto lambda = [&](QSharedPointer<DownloadStringJob> job) {
         int matches = 0;
-        for (auto &match : getAllRxMatches(mangarx, job->bufferStr))
+        for (auto &match : getAllRxMatches(mangarx, job->text()))
         {
             auto title = htmlToPlainText(match.captured(2));
             auto url = match.captured(1);
@@ -61,7 +61,7 @@ bool MangaHere::updateMangaList(UpdateProgressToken *token)
         urls.append(dictionaryUrl + QString::number(i) + ".htm");
 
     DownloadQueue queue(networkManager, urls, CONF.parallelDownloadsHigh, lambda, true);
-    queue.setCancellationToken(&token->canceled);
+    queue.setCancellationToken(&token->cancellation);
     queue.start();
     if (!queue.awaitCompletion())
     {
@@ -93,18 +93,18 @@ Result<MangaChapterCollection, QString> MangaHere::updateMangaInfoFinishedLoadin
     QRegularExpression chapterrx(
         R"lit(<a href="(/manga/[^"]*?)" title=".*?<p class="title3">([^<]*?)</p>)lit");
 
-    fillMangaInfo(info, job->bufferStr, authorrx, artistrx, statusrx, yearrx, genresrx, summaryrx, coverrx);
+    fillMangaInfo(info, job->text(), authorrx, artistrx, statusrx, yearrx, genresrx, summaryrx, coverrx);
 
     info->genres = info->genres.remove("- ");
     info->status = info->status.remove('\n');
     if (info->status.contains('-'))
         info->status = info->status.split('-')[0];
 
-    int spos = job->bufferStr.indexOf(R"(<div id="chapterlist">)");
-    int epos = job->bufferStr.indexOf(R"(<div class="fb-comments)", spos);
+    int spos = job->text().indexOf(R"(<div id="chapterlist">)");
+    int epos = job->text().indexOf(R"(<div class="fb-comments)", spos);
 
     MangaChapterCollection newchapters;
-    for (auto &chapterrxmatch : getAllRxMatches(chapterrx, job->bufferStr, spos, epos))
+    for (auto &chapterrxmatch : getAllRxMatches(chapterrx, job->text(), spos, epos))
         newchapters.insert(0, MangaChapter(chapterrxmatch.captured(2), baseUrl + chapterrxmatch.captured(1)));
     info->chapters.mergeChapters(newchapters);
 
@@ -119,13 +119,13 @@ Result<QStringList, QString> MangaHere::getPageList(const QString &chapterUrl)
     auto job = networkManager->downloadAsString(chapterUrl);
 
     if (!job->await(7000))
-        return Err(job->errorString);
+        return Err(job->errorString());
 
-    int spos = job->bufferStr.indexOf(R"(<div class="vung-doc" id="vungdoc">)");
-    int epos = job->bufferStr.indexOf(R"(class="navi-change-chapter">)", spos);
+    int spos = job->text().indexOf(R"(<div class="vung-doc" id="vungdoc">)");
+    int epos = job->text().indexOf(R"(class="navi-change-chapter">)", spos);
 
     QStringList imageUrls;
-    for (auto &match : getAllRxMatches(pagerx, job->bufferStr, spos, epos))
+    for (auto &match : getAllRxMatches(pagerx, job->text(), spos, epos))
     {
         auto imageUrl = match.captured(1);
         if (!imageUrl.contains("/themes/"))
@@ -15,7 +15,7 @@ bool MangaHub::updateMangaList(UpdateProgressToken *token)
 
     if (!job->await(7000))
     {
-        token->sendError(job->errorString);
+        token->sendError(job->errorString());
         return true;
     }
 
@@ -32,25 +32,24 @@ bool MangaHub::updateMangaList(UpdateProgressToken *token)
     const int matchesPerPage = 30;
     int noMatchCounter = 0;
 
-    auto lambda = [&](QSharedPointer<DownloadStringJob> job) {
-        int matches = 0;
-        for (auto &match : getAllRxMatches(mangarx, job->bufferStr))
-        {
-            auto title = htmlToPlainText(match.captured(2));
-            auto url = match.captured(1);
-            mangas.append(title, url);
-            matches++;
-        }
+    auto addEntries = [&](HtmlStreamScanner *scanner) {
+        for (const auto &entry : qAsConst(scanner->entries))
+            mangas.append(htmlToPlainText(entry.title), entry.url);
 
-        if (matches == 0)
+        if (scanner->entries.isEmpty())
             noMatchCounter++;
 
         token->sendProgress(10 + 90 * (mangas.size / matchesPerPage) / pages);
 
-        qDebug() << "matches:" << matches;
+        qDebug() << "matches:" << scanner->entries.count();
     };
 
-    lambda(job);
+    auto newScanner = [&]() { return QSharedPointer<HtmlStreamScanner>::create("", "", mangarx); };
+
+    auto firstPage = newScanner();
+    firstPage->feed(job->buffer);
+    firstPage->finish();
+    addEntries(firstPage.get());
 
     int oldPages = 1;
     while (noMatchCounter < 2 && pages < 2000)
@@ -61,8 +60,12 @@ bool MangaHub::updateMangaList(UpdateProgressToken *token)
         for (int i = oldPages + 1; i <= pages; i++)
             urls.append(dicturl + QString::number(i));
 
-        DownloadQueue queue(networkManager, urls, CONF.parallelDownloadsMid, lambda, true);
-        queue.setCancellationToken(&token->canceled);
+        // the pages are scanned while they are downloaded
+        DownloadQueue queue(networkManager, urls, CONF.parallelDownloadsMid,
+                            [&](QSharedPointer<DownloadStringJob> job) { addEntries(job->scanner.get()); },
+                            true);
+        queue.setStreamScanner(newScanner);
+        queue.setCancellationToken(&token->cancellation);
         queue.start();
         if (!queue.awaitCompletion())
         {
@@ -96,7 +99,7 @@ Result<MangaChapterCollection, QString> MangaHub::updateMangaInfoFinishedLoading
     QRegularExpression chapterrx(
         R"lit(<a href="(https://mangahub.io/chapter/[^"]+)"[^>]*>(.*?)</span></span>)lit");
 
-    fillMangaInfo(info, job->bufferStr, authorrx, artistrx, statusrx, yearrx, genresrx, summaryrx, coverrx);
+    fillMangaInfo(info, job->text(), authorrx, artistrx, statusrx, yearrx, genresrx, summaryrx, coverrx);
 
     // fix genres spacing
     for (int i = 1; i < info->genres.size(); i++)
@@ -108,11 +111,11 @@ Result<MangaChapterCollection, QString> MangaHub::updateMangaInfoFinishedLoading
         }
     }
 
-    auto spos = job->bufferStr.indexOf(R"(<div class="tab-content">)");
-    auto epos = job->bufferStr.indexOf(R"(<section id="comments">)");
+    auto spos = job->text().indexOf(R"(<div class="tab-content">)");
+    auto epos = job->text().indexOf(R"(<section id="comments">)");
 
     MangaChapterCollection newchapters;
-    for (auto &chapterrxmatch : getAllRxMatches(chapterrx, job->bufferStr, spos, epos))
+    for (auto &chapterrxmatch : getAllRxMatches(chapterrx, job->text(), spos, epos))
         newchapters.insert(
             0, MangaChapter(htmlToPlainText(chapterrxmatch.captured(2)), chapterrxmatch.captured(1)));
 
@@ -155,10 +158,10 @@ Result<QStringList, QString> MangaHub::getPageList(const QString &chapterUrl)
     auto job = networkManager->downloadAsString(chapterUrl);
 
     if (!job->await(7000))
-        return Err(job->errorString);
+        return Err(job->errorString());
 
-    auto imagerxmatch = imagerx.match(job->bufferStr);
-    auto numimagesrxmatch = numimagesrx.match(job->bufferStr);
+    auto imagerxmatch = imagerx.match(job->text());
+    auto numimagesrxmatch = numimagesrx.match(job->text());
 
     if (!imagerxmatch.hasMatch())
         return Err(QString("Error. Couldn't process pages/images."));
@@ -10,6 +10,7 @@ Mangakakalot::Mangakakalot(NetworkManager *networkManager) : AbstractMangaSource
     networkManager->addCookie("manganelo.com", "content_lazyload", "off");
     networkManager->addSetCustomRequestHeader("mangakakalot", "Referer",
                                               R"(https://mangakakalot.com/chapter/)");
+    networkManager->setHostConnectionPolicy("mangakakalot.com", HostConnectionPolicy(false, 2));
 }
 
 bool Mangakakalot::updateMangaList(UpdateProgressToken *token)
@@ -25,7 +26,7 @@ bool Mangakakalot::updateMangaList(UpdateProgressToken *token)
 
     if (!job->await(7000))
     {
-        token->sendError(job->errorString);
+        token->sendError(job->errorString());
         return false;
     }
 
@@ -34,8 +35,8 @@ bool Mangakakalot::updateMangaList(UpdateProgressToken *token)
     QElapsedTimer timer;
     timer.start();
 
-    auto nummangasrxmatch = nummangasrx.match(job->bufferStr);
-    auto numpagesrxmatch = numpagesrx.match(job->bufferStr);
+    auto nummangasrxmatch = nummangasrx.match(job->text());
+    auto numpagesrxmatch = numpagesrx.match(job->text());
 
     int nominalSize = 0;
     if (nummangasrxmatch.hasMatch())
@@ -49,34 +50,33 @@ bool Mangakakalot::updateMangaList(UpdateProgressToken *token)
         pages = numpagesrxmatch.captured(1).toInt();
 
     const int matchesPerPage = 24;
-    auto lambda = [&](QSharedPointer<DownloadStringJob> job) {
-        int spos = job->bufferStr.indexOf(rxstart);
-        int epos = job->bufferStr.indexOf(rxend);
-
-        int matches = 0;
-        for (auto &match : getAllRxMatches(mangarx, job->bufferStr, spos, epos))
-        {
-            auto title = htmlToPlainText(match.captured(2));
-            auto url = match.captured(1);
-            mangas.append(title, url);
-            matches++;
-        }
+    auto addEntries = [&](HtmlStreamScanner *scanner) {
+        for (const auto &entry : qAsConst(scanner->entries))
+            mangas.append(htmlToPlainText(entry.title), entry.url);
 
         token->sendProgress(10 + 90 * (mangas.size / matchesPerPage) / pages);
-        qDebug() << "matches:" << matches;
+        qDebug() << "matches:" << scanner->entries.count();
     };
 
+    auto newScanner = [&]() { return QSharedPointer<HtmlStreamScanner>::create(rxstart, rxend, mangarx); };
+
     if (nominalSize != mangas.size)
         qDebug() << "Not all mangas captured:" << nominalSize << "vs" << mangas.size;
 
-    lambda(job);
+    auto firstPage = newScanner();
+    firstPage->feed(job->buffer);
+    firstPage->finish();
+    addEntries(firstPage.get());
 
     QList<QString> urls;
     for (int i = 2; i <= pages; i++)
         urls.append(dictionaryUrl + QString::number(i));
 
-    DownloadQueue queue(networkManager, urls, CONF.parallelDownloadsHigh, lambda, true);
-    queue.setCancellationToken(&token->canceled);
+    // the other pages are scanned while they are downloaded
+    DownloadQueue queue(networkManager, urls, CONF.parallelDownloadsHigh,
+                        [&](QSharedPointer<DownloadStringJob> job) { addEntries(job->scanner.get()); }, true);
+    queue.setStreamScanner(newScanner);
+    queue.setCancellationToken(&token->cancellation);
     queue.start();
     if (!queue.awaitCompletion())
     {
@@ -109,18 +109,18 @@ Result<MangaChapterCollection, QString> Mangakakalot::updateMangaInfoFinishedLoa
 
     QRegularExpression chapterrx(R"lit(<a[^>]*?href="([^"]*)"[^>]*>([^<]*)<)lit");
 
-    fillMangaInfo(info, job->bufferStr, authorrx, artistrx, statusrx, yearrx, genresrx, summaryrx, coverrx);
+    fillMangaInfo(info, job->text(), authorrx, artistrx, statusrx, yearrx, genresrx, summaryrx, coverrx);
 
     info->genres = info->genres.remove("- ");
     info->status = info->status.remove('\n');
     if (info->status.contains('-'))
         info->status = info->status.split('-')[0];
 
-    int spos = job->bufferStr.indexOf(R"(chapter-list">)");
-    int epos = job->bufferStr.indexOf(R"(<div class="fb-comments)", spos);
+    int spos = job->text().indexOf(R"(chapter-list">)");
+    int epos = job->text().indexOf(R"(<div class="fb-comments)", spos);
 
     MangaChapterCollection newchapters;
-    for (auto &chapterrxmatch : getAllRxMatches(chapterrx, job->bufferStr, spos, epos))
+    for (auto &chapterrxmatch : getAllRxMatches(chapterrx, job->text(), spos, epos))
         newchapters.insert(0, MangaChapter(chapterrxmatch.captured(2), chapterrxmatch.captured(1)));
 
     return Ok(newchapters);
@@ -133,15 +133,15 @@ Result<QStringList, QString> Mangakakalot::getPageList(const QString &chapterUrl
     auto job = networkManager->downloadAsString(chapterUrl);
 
     if (!job->await(7000))
-        return Err(job->errorString);
+        return Err(job->errorString());
 
-    int spos = job->bufferStr.indexOf(R"(<div class="vung-doc" id="vungdoc">)");
+    int spos = job->text().indexOf(R"(<div class="vung-doc" id="vungdoc">)");
     if (spos < 0)
-        spos = job->bufferStr.indexOf(R"(<div class="container-chapter-reader">)");
-    int epos = job->bufferStr.indexOf(R"(class="navi-change-chapter">)", spos);
+        spos = job->text().indexOf(R"(<div class="container-chapter-reader">)");
+    int epos = job->text().indexOf(R"(class="navi-change-chapter">)", spos);
 
     QStringList imageUrls;
-    for (auto &match : getAllRxMatches(pagerx, job->bufferStr, spos, epos))
+    for (auto &match : getAllRxMatches(pagerx, job->text(), spos, epos))
     {
         auto imageUrl = match.captured(1);
         if (!imageUrl.contains("/themes/"))
@@ -19,7 +19,7 @@ bool MangaOwl::updateMangaList(UpdateProgressToken *token)
 
     if (!job->await(7000))
     {
-        token->sendError(job->errorString);
+        token->sendError(job->errorString());
         return false;
     }
 
@@ -28,7 +28,7 @@ bool MangaOwl::updateMangaList(UpdateProgressToken *token)
     QElapsedTimer timer;
     timer.start();
 
-    auto numpagesrxmatch = numpagesrx.match(job->bufferStr);
+    auto numpagesrxmatch = numpagesrx.match(job->text());
 
     int pages = 1;
     if (numpagesrxmatch.hasMatch())
@@ -42,7 +42,7 @@ bool MangaOwl::updateMangaList(UpdateProgressToken *token)
     const int matchesPerPage = 36;
     auto lambda = [&](QSharedPointer<DownloadStringJob> job) {
         int matches = 0;
-        for (auto &match : getAllRxMatches(mangarx, job->bufferStr))
+        for (auto &match : getAllRxMatches(mangarx, job->text()))
         {
             auto title = htmlToPlainText(match.captured(1));
             auto url = match.captured(2);
@@ -61,7 +61,7 @@ bool MangaOwl::updateMangaList(UpdateProgressToken *token)
         urls.append(mangalistUrl + QString::number(i));
 
     DownloadQueue queue(networkManager, urls, CONF.parallelDownloadsHigh, lambda, true);
-    queue.setCancellationToken(&token->canceled);
+    queue.setCancellationToken(&token->cancellation);
     queue.start();
     if (!queue.awaitCompletion())
     {
@@ -97,10 +97,10 @@ Result<MangaChapterCollection, QString> MangaOwl::updateMangaInfoFinishedLoading
         R"lit(<a[^>]*class="chapter-url"[^>]*href="([^"]*)"[^>]*>\s*<label[^>]*>\s*(.*?)\s*</label>)lit",
         QRegularExpression::DotMatchesEverythingOption);
 
-    fillMangaInfo(info, job->bufferStr, authorrx, artistrx, statusrx, yearrx, genresrx, summaryrx, coverrx);
+    fillMangaInfo(info, job->text(), authorrx, artistrx, statusrx, yearrx, genresrx, summaryrx, coverrx);
 
     MangaChapterCollection newchapters;
-    for (auto &chapterrxmatch : getAllRxMatches(chapterrx, job->bufferStr))
+    for (auto &chapterrxmatch : getAllRxMatches(chapterrx, job->text()))
         newchapters.insert(
             0, MangaChapter(htmlToPlainText(chapterrxmatch.captured(2)), chapterrxmatch.captured(1)));
 
@@ -114,10 +114,10 @@ Result<QStringList, QString> MangaOwl::getPageList(const QString &chapterUrl)
     auto job = networkManager->downloadAsString(chapterUrl);
 
     if (!job->await(7000))
-        return Err(job->errorString);
+        return Err(job->errorString());
 
     QStringList imageUrls;
-    for (auto &match : getAllRxMatches(pagerx, job->bufferStr))
+    for (auto &match : getAllRxMatches(pagerx, job->text()))
     {
         imageUrls.append(match.captured(1));
     }
@@ -17,7 +17,7 @@ bool MangaPanda::updateMangaList(UpdateProgressToken *token)
 
     if (!job->await(10000))
     {
-        token->sendError(job->errorString);
+        token->sendError(job->errorString());
         return false;
     }
 
@@ -26,7 +26,7 @@ bool MangaPanda::updateMangaList(UpdateProgressToken *token)
     QElapsedTimer timer;
     timer.start();
 
-    auto numpagesrxmatch = numpagesrx.match(job->bufferStr);
+    auto numpagesrxmatch = numpagesrx.match(job->text());
 
     MangaList mangas;
     mangas.absoluteUrls = true;
@@ -37,33 +37,37 @@ bool MangaPanda::updateMangaList(UpdateProgressToken *token)
     qDebug() << "pages:" << pages;
 
     const int matchesPerPage = 30;
-    auto lambda = [&](QSharedPointer<DownloadStringJob> job) {
-        int matches = 0;
-        int spos = job->bufferStr.indexOf(R"(<span>Popular Manga</span>)");
-        int epos = job->bufferStr.indexOf(R"(<li class="active">)");
-
-        for (auto &match : getAllRxMatches(mangarx, job->bufferStr, spos, epos))
-        {
-            auto title = htmlToPlainText(match.captured(2));
-            auto url = match.captured(1);
-            mangas.append(title, url);
-            matches++;
-        }
+    auto addEntries = [&](HtmlStreamScanner *scanner, const QString &url) {
+        for (const auto &entry : qAsConst(scanner->entries))
+            mangas.append(htmlToPlainText(entry.title), entry.url);
 
+        int matches = scanner->entries.count();
         token->sendProgress(10 + 90 * (mangas.size / matchesPerPage) / pages);
         qDebug() << "matches:" << matches;
         if (matches < matchesPerPage)
-            qDebug() << "       Incomplete match in page:" << job->url;
+            qDebug() << "       Incomplete match in page:" << url;
     };
 
-    lambda(job);
+    auto newScanner = [&]() {
+        return QSharedPointer<HtmlStreamScanner>::create(R"(<span>Popular Manga</span>)",
+                                                         R"(<li class="active">)", mangarx);
+    };
+
+    auto firstPage = newScanner();
+    firstPage->feed(job->buffer);
+    firstPage->finish();
+    addEntries(firstPage.get(), job->url);
 
     QList<QString> urls;
     for (int i = 2; i < pages; i++)
         urls.append(dictionaryUrl + QString::number(i));
 
-    DownloadQueue queue(networkManager, urls, CONF.parallelDownloadsHigh, lambda, true);
-    queue.setCancellationToken(&token->canceled);
+    // the other pages are scanned while they are downloaded
+    DownloadQueue queue(
+        networkManager, urls, CONF.parallelDownloadsHigh,
+        [&](QSharedPointer<DownloadStringJob> job) { addEntries(job->scanner.get(), job->url); }, true);
+    queue.setStreamScanner(newScanner);
+    queue.setCancellationToken(&token->cancellation);
     queue.start();
     if (!queue.awaitCompletion())
     {
@@ -93,12 +97,12 @@ Result<MangaChapterCollection, QString> MangaPanda::updateMangaInfoFinishedLoadi
 
     QRegularExpression chapterrx(R"lit(<span><a\W*href="([^"]*)"\W*title="([^"]*)">)lit");
 
-    fillMangaInfo(info, job->bufferStr, authorrx, artistrx, statusrx, yearrx, genresrx, summaryrx, coverrx);
+    fillMangaInfo(info, job->text(), authorrx, artistrx, statusrx, yearrx, genresrx, summaryrx, coverrx);
 
     info->author = info->author.remove(',');
 
     MangaChapterCollection newchapters;
-    for (auto &chapterrxmatch : getAllRxMatches(chapterrx, job->bufferStr))
+    for (auto &chapterrxmatch : getAllRxMatches(chapterrx, job->text()))
     {
         auto ctitle = chapterrxmatch.captured(2);
         auto curl = chapterrxmatch.captured(1);
@@ -114,9 +118,9 @@ Result<QStringList, QString> MangaPanda::getPageList(const QString &chapterUrl)
     auto job = networkManager->downloadAsString(chapterUrl);
 
     if (!job->await(7000))
-        return Err(job->errorString);
+        return Err(job->errorString());
 
-    auto pagerxmatch = pagerx.match(job->bufferStr);
+    auto pagerxmatch = pagerx.match(job->text());
 
     if (!pagerxmatch.hasMatch())
         return Err(QString("Couldn't parse pages."));
@@ -8,6 +8,11 @@ MangaPlus::MangaPlus(NetworkManager *dm) : AbstractMangaSource(dm)
     chapterDetailUrl = "api/title_detail?title_id=%1";
     pagesUrl = "api/manga_viewer?chapter_id=%1&img_quality=super_high&split=yes";
 
+    networkManager->setHostConnectionPolicy("tokyo-cdn.com", HostConnectionPolicy(true));
+
+    // approximate page sizes of the img_quality levels
+    imageVariants = {{"low", QSize(480, 690)}, {"high", QSize(784, 1130)}, {"super_high", QSize(1200, 1730)}};
+
     invalidatePagelist();
 }
 
@@ -40,7 +45,7 @@ bool MangaPlus::updateMangaList(UpdateProgressToken *token)
 
     if (!job->await(7000))
     {
-        token->sendError(job->errorString);
+        token->sendError(job->errorString());
         return false;
     }
     picoproto::Message message;
@@ -164,10 +169,18 @@ Result<MangaChapterCollection, QString> MangaPlus::updateMangaInfoFinishedLoadin
 
 Result<QStringList, QString> MangaPlus::getPageList(const QString &chapterUrl)
 {
-    auto job = networkManager->downloadToBuffer(baseUrl + chapterUrl);
+    // stored chapter urls ask for super_high, the quality is chosen for the screen at request time
+    auto variant = pickImageVariant();
+    QUrl url(baseUrl + chapterUrl);
+    QUrlQuery query(url);
+    query.removeAllQueryItems("img_quality");
+    query.addQueryItem("img_quality", variant.name);
+    url.setQuery(query);
+
+    auto job = networkManager->downloadToBuffer(url.toString());
 
     if (!job->await(7000))
-        return Err(job->errorString);
+        return Err(job->errorString());
 
     picoproto::Message message;
     message.ParseFromBytes((uint8_t *)job->buffer.data(), job->buffer.size());
@@ -211,7 +224,7 @@ Result<QStringList, QString> MangaPlus::getPageList(const QString &chapterUrl)
             xorkey = mangapage->GetString(5);
         auto pageurl = mangapage->GetString(1);
 
-        auto urlencoded = QString::fromUtf8(pageurl.c_str());
+        auto urlencoded = variantImageUrl(QString::fromUtf8(pageurl.c_str()), variant);
         if (xorkey.length() > 0)
             urlencoded += QString("|xor:") + xorkey.c_str();
         imageUrls.append(urlencoded);
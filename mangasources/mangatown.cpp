@@ -17,7 +17,7 @@ bool MangaTown::updateMangaList(UpdateProgressToken *token)
 
     if (!job->await())
     {
-        token->sendError(job->errorString);
+        token->sendError(job->errorString());
         return false;
     }
 
@@ -26,7 +26,7 @@ bool MangaTown::updateMangaList(UpdateProgressToken *token)
     QElapsedTimer timer;
     timer.start();
 
-    auto numpagesrxmatch = numpagesrx.match(job->bufferStr);
+    auto numpagesrxmatch = numpagesrx.match(job->text());
 
     MangaList mangas;
     mangas.absoluteUrls = false;
@@ -37,30 +37,34 @@ bool MangaTown::updateMangaList(UpdateProgressToken *token)
     qDebug() << "pages:" << pages;
 
     const int matchesPerPage = 30;
-    auto lambda = [&](QSharedPointer<DownloadStringJob> job) {
-        int matches = 0;
-        for (auto &match : getAllRxMatches(mangarx, job->bufferStr))
-        {
-            auto title = htmlToPlainText(match.captured(2));
-            auto url = match.captured(1);
-            mangas.append(title, url);
-            matches++;
-        }
+    auto addEntries = [&](HtmlStreamScanner *scanner, const QString &url) {
+        for (const auto &entry : qAsConst(scanner->entries))
+            mangas.append(htmlToPlainText(entry.title), entry.url);
 
+        int matches = scanner->entries.count();
         token->sendProgress(10 + 90 * (mangas.size / matchesPerPage) / pages);
         qDebug() << "matches:" << matches;
         if (matches < matchesPerPage)
-            qDebug() << "          Incomplete match in page:" << job->url;
+            qDebug() << "          Incomplete match in page:" << url;
     };
 
-    lambda(job);
+    auto newScanner = [&]() { return QSharedPointer<HtmlStreamScanner>::create("", "", mangarx); };
+
+    auto firstPage = newScanner();
+    firstPage->feed(job->buffer);
+    firstPage->finish();
+    addEntries(firstPage.get(), job->url);
 
     QList<QString> urls;
     for (int i = 2; i <= pages; i++)
         urls.append(dictionaryUrl + QString::number(i) + ".htm");
 
-    DownloadQueue queue(networkManager, urls, CONF.parallelDownloadsHigh, lambda, true);
-    queue.setCancellationToken(&token->canceled);
+    // the other pages are scanned while they are downloaded
+    DownloadQueue queue(
+        networkManager, urls, CONF.parallelDownloadsHigh,
+        [&](QSharedPointer<DownloadStringJob> job) { addEntries(job->scanner.get(), job->url); }, true);
+    queue.setStreamScanner(newScanner);
+    queue.setCancellationToken(&token->cancellation);
     queue.start();
     if (!queue.awaitCompletion())
     {
@@ -91,13 +95,13 @@ Result<MangaChapterCollection, QString> MangaTown::updateMangaInfoFinishedLoadin
 
     QRegularExpression chapterrx(R"lit(<a href="(/manga/[^"]*?)"[^>]*?>([^<]*))lit");
 
-    fillMangaInfo(info, job->bufferStr, authorrx, artistrx, statusrx, yearrx, genresrx, summaryrx, coverrx);
+    fillMangaInfo(info, job->text(), authorrx, artistrx, statusrx, yearrx, genresrx, summaryrx, coverrx);
 
-    int spos = job->bufferStr.indexOf(R"(<ul class="chapter_list">)");
-    int epos = job->bufferStr.indexOf(R"(<div class="comment_content">)", spos);
+    int spos = job->text().indexOf(R"(<ul class="chapter_list">)");
+    int epos = job->text().indexOf(R"(<div class="comment_content">)", spos);
 
     MangaChapterCollection newchapters;
-    for (auto &chapterrxmatch : getAllRxMatches(chapterrx, job->bufferStr, spos, epos))
+    for (auto &chapterrxmatch : getAllRxMatches(chapterrx, job->text(), spos, epos))
         newchapters.insert(0, MangaChapter(chapterrxmatch.captured(2), baseUrl + chapterrxmatch.captured(1)));
 
     return Ok(newchapters);
@@ -111,9 +115,9 @@ Result<QStringList, QString> MangaTown::getPageList(const QString &chapterUrl)
     auto job = networkManager->downloadAsString(chapterUrl);
 
     if (!job->await(7000))
-        return Err(job->errorString);
+        return Err(job->errorString());
 
-    auto numPagesRxMatch = numPagesRx.match(job->bufferStr);
+    auto numPagesRxMatch = numPagesRx.match(job->text());
 
     if (!numPagesRxMatch.hasMatch())
         return Err(QString("Couldn't process pagelist."));
@@ -137,9 +141,9 @@ Result<QString, QString> MangaTown::getImageUrl(const QString &pageUrl)
     auto job = networkManager->downloadAsString(pageUrl);
 
     if (!job->await(6000))
-        return Err(job->errorString);
+        return Err(job->errorString());
 
-    auto match = imgUrlRx.match(job->bufferStr);
+    auto match = imgUrlRx.match(job->text());
 
     if (!match.hasMatch())
         return Err(QString("Couldn't process pages/images."));
@@ -25,7 +25,7 @@ bool MangaWindow::updateMangaList()
 
     if (!job->await(6000))
     {
-        emit updateError(job->errorString);
+        emit updateError(job->errorString());
         return false;
     }
 
@@ -72,9 +72,9 @@ bool MangaWindow::updateMangaList()
         //        (batch) * maxparalleldownloads && rxi > 0; rxi--)
         for (; rxi < (batch + 1) * maxparalleldownloads && rxi < pages; rxi++)
         {
-            if (!jobs[rxi]->await(15000, true))
+            if (!jobs[rxi]->await(15000))
             {
-                emit updateError(jobs[rxi]->errorString);
+                emit updateError(jobs[rxi]->errorString());
                 return false;
             }
 
@@ -155,7 +155,7 @@ QSharedPointer<MangaInfo> MangaWindow::getMangaInfo(const QString &mangalink)
 
     if (!job->await(3000))
     {
-        qDebug() << job->errorString;
+        qDebug() << job->errorString();
         return info;
     }
 
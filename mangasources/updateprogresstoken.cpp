@@ -1,7 +1,7 @@
 #include "updateprogresstoken.h"
 
 UpdateProgressToken::UpdateProgressToken()
-    : QObject(), currentSourceName(), sourcesProgress(), canceled(false)
+    : QObject(), currentSourceName(), sourcesProgress(), cancellation()
 {
 }
 
@@ -4,6 +4,8 @@
 #include <QMap>
 #include <QObject>
 
+#include "cancellationtoken.h"
+
 class UpdateProgressToken : public QObject
 {
     Q_OBJECT
@@ -17,7 +19,7 @@ public:
 
     QString currentSourceName;
     QMap<QString, int> sourcesProgress;
-    bool canceled;
+    CancellationToken cancellation;
 signals:
     void updateProgress();
     void updateError(const QString &message);
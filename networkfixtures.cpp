@@ -0,0 +1,180 @@
+#include "networkfixtures.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QTimer>
+
+NetworkFixtures::NetworkFixtures() : currentMode(Off), directory(), replayLatency(false) {}
+
+void NetworkFixtures::setMode(Mode mode, const QString &directory, bool replayLatency)
+{
+    this->currentMode = mode;
+    this->directory = directory.endsWith('/') ? directory : directory + '/';
+    this->replayLatency = replayLatency;
+
+    if (mode != Off)
+        qDebug() << "Network fixtures" << (mode == Record ? "recording to" : "replayed from")
+                 << this->directory;
+}
+
+NetworkFixtures::Mode NetworkFixtures::mode() const
+{
+    return currentMode;
+}
+
+QByteArray NetworkFixtures::methodOf(QNetworkAccessManager::Operation op, const QNetworkRequest &request)
+{
+    switch (op)
+    {
+        case QNetworkAccessManager::HeadOperation:
+            return "HEAD";
+        case QNetworkAccessManager::GetOperation:
+            return "GET";
+        case QNetworkAccessManager::PutOperation:
+            return "PUT";
+        case QNetworkAccessManager::PostOperation:
+            return "POST";
+        case QNetworkAccessManager::DeleteOperation:
+            return "DELETE";
+        default:
+            return request.attribute(QNetworkRequest::CustomVerbAttribute).toByteArray();
+    }
+}
+
+QString NetworkFixtures::fixturePath(const QByteArray &method, const QUrl &url,
+                                     const QByteArray &requestBody) const
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(method);
+    hash.addData(url.toEncoded());
+    hash.addData(requestBody);
+
+    return directory + url.host() + "/" + hash.result().toHex() + ".fixture";
+}
+
+bool NetworkFixtures::load(const QString &path, NetworkFixture &fixture) const
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    in >> fixture.method >> fixture.url >> fixture.requestBody >> fixture.status >> fixture.reason >>
+        fixture.headers >> fixture.body >> fixture.error >> fixture.errorString >> fixture.firstByte >>
+        fixture.total;
+    file.close();
+
+    return in.status() == QDataStream::Ok;
+}
+
+void NetworkFixtures::save(const QString &path, const NetworkFixture &fixture) const
+{
+    QDir().mkpath(QFileInfo(path).path());
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+
+    QDataStream out(&file);
+    out << fixture.method << fixture.url << fixture.requestBody << fixture.status << fixture.reason
+        << fixture.headers << fixture.body << fixture.error << fixture.errorString << fixture.firstByte
+        << fixture.total;
+    file.close();
+}
+
+QNetworkReply *NetworkFixtures::record(QNetworkReply *reply, QNetworkAccessManager::Operation op,
+                                       const QNetworkRequest &request, const QByteArray &requestBody,
+                                       QObject *parent)
+{
+    auto proxy = new BufferedNetworkReply(op, request, parent);
+    reply->setParent(proxy);
+
+    auto fixture = QSharedPointer<NetworkFixture>::create();
+    fixture->method = methodOf(op, request);
+    fixture->url = request.url().toString();
+    fixture->requestBody = requestBody;
+
+    auto path = fixturePath(fixture->method, request.url(), requestBody);
+
+    QElapsedTimer timer;
+    timer.start();
+
+#if QT_VERSION >= QT_VERSION_CHECK(6, 3, 0)
+    QObject::connect(reply, &QNetworkReply::socketStartedConnecting, proxy,
+                     &QNetworkReply::socketStartedConnecting);
+    QObject::connect(reply, &QNetworkReply::requestSent, proxy, &QNetworkReply::requestSent);
+#endif
+    QObject::connect(reply, &QNetworkReply::encrypted, proxy, &QNetworkReply::encrypted);
+    QObject::connect(reply, &QNetworkReply::sslErrors, proxy, &QNetworkReply::sslErrors);
+
+    QObject::connect(reply, &QNetworkReply::metaDataChanged, proxy, [reply, proxy, fixture, timer]() {
+        fixture->status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        fixture->reason = reply->attribute(QNetworkRequest::HttpReasonPhraseAttribute).toByteArray();
+        fixture->headers = reply->rawHeaderPairs();
+        fixture->firstByte = timer.elapsed();
+
+        proxy->copyResponse(reply);
+    });
+
+    // only take what the reader has room for, the rest stays in the real reply and throttles the socket
+    auto forward = [this, reply, proxy, fixture, path, timer]() {
+        auto data = reply->read(qMin(reply->bytesAvailable(), proxy->bufferSpace()));
+        fixture->body.append(data);
+        proxy->appendData(data);
+
+        if (!reply->isFinished() || reply->bytesAvailable() > 0 || proxy->isFinished())
+            return;
+
+        fixture->error = reply->error();
+        fixture->errorString = reply->errorString();
+        fixture->total = timer.elapsed();
+
+        // don't record our own aborts, they are no property of the server
+        if (reply->error() != QNetworkReply::OperationCanceledError)
+            save(path, *fixture);
+
+        proxy->finishReply(reply->error(), reply->errorString());
+    };
+    QObject::connect(reply, &QNetworkReply::readyRead, proxy, forward);
+    QObject::connect(reply, &QNetworkReply::finished, proxy, forward);
+    QObject::connect(proxy, &BufferedNetworkReply::dataConsumed, proxy, forward, Qt::QueuedConnection);
+    QObject::connect(proxy, &BufferedNetworkReply::readBufferSizeChanged, reply,
+                     &QNetworkReply::setReadBufferSize);
+    QObject::connect(proxy, &BufferedNetworkReply::abortRequested, reply, &QNetworkReply::abort);
+    QObject::connect(proxy, &BufferedNetworkReply::ignoreSslErrorsRequested, reply,
+                     QOverload<>::of(&QNetworkReply::ignoreSslErrors));
+
+    return proxy;
+}
+
+QNetworkReply *NetworkFixtures::replay(QNetworkAccessManager::Operation op, const QNetworkRequest &request,
+                                       const QByteArray &requestBody, QObject *parent)
+{
+    auto reply = new BufferedNetworkReply(op, request, parent);
+
+    auto fixture = QSharedPointer<NetworkFixture>::create();
+    if (!load(fixturePath(methodOf(op, request), request.url(), requestBody), *fixture))
+    {
+        qDebug() << "No fixture for" << request.url().toString();
+        fixture->error = QNetworkReply::ContentNotFoundError;
+        fixture->errorString = "No fixture for " + request.url().toString();
+    }
+
+    qint64 firstByte = replayLatency ? fixture->firstByte : 0;
+    qint64 total = replayLatency ? fixture->total : 0;
+
+    // always deliver asynchronously like a real reply
+    QTimer::singleShot(firstByte, reply, [reply, fixture]() {
+        if (reply->isFinished())
+            return;
+        if (fixture->status > 0)
+            reply->setResponse(fixture->status, fixture->reason, fixture->headers);
+        reply->appendData(fixture->body);
+    });
+    QTimer::singleShot(qMax(firstByte, total), reply, [reply, fixture]() {
+        reply->finishReply((QNetworkReply::NetworkError)fixture->error, fixture->errorString);
+    });
+
+    return reply;
+}
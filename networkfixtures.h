@@ -0,0 +1,61 @@
+#ifndef NETWORKFIXTURES_H
+#define NETWORKFIXTURES_H
+
+#include "bufferednetworkreply.h"
+
+struct NetworkFixture
+{
+    QByteArray method;
+    QString url;
+    QByteArray requestBody;
+
+    int status = 0;
+    QByteArray reason;
+    QList<QNetworkReply::RawHeaderPair> headers;
+    QByteArray body;
+    int error = QNetworkReply::NoError;
+    QString errorString;
+
+    // ms after the request was made
+    qint64 firstByte = 0;
+    qint64 total = 0;
+};
+
+// Records request/response pairs to a fixture directory and serves them back, so that list updates,
+// info parsing and chapter downloads can be benchmarked and tested without the live sites.
+// One file per method, url and request body, the last recording wins.
+// Replay answers from the fixtures only, optionally with the recorded latencies.
+// Requests without a fixture fail with ContentNotFoundError.
+class NetworkFixtures
+{
+public:
+    enum Mode
+    {
+        Off,
+        Record,
+        Replay
+    };
+
+    NetworkFixtures();
+
+    void setMode(Mode mode, const QString &directory, bool replayLatency = false);
+    Mode mode() const;
+
+    QNetworkReply *record(QNetworkReply *reply, QNetworkAccessManager::Operation op,
+                          const QNetworkRequest &request, const QByteArray &requestBody, QObject *parent);
+    QNetworkReply *replay(QNetworkAccessManager::Operation op, const QNetworkRequest &request,
+                          const QByteArray &requestBody, QObject *parent);
+
+    static QByteArray methodOf(QNetworkAccessManager::Operation op, const QNetworkRequest &request);
+
+private:
+    Mode currentMode;
+    QString directory;
+    bool replayLatency;
+
+    QString fixturePath(const QByteArray &method, const QUrl &url, const QByteArray &requestBody) const;
+    bool load(const QString &path, NetworkFixture &fixture) const;
+    void save(const QString &path, const NetworkFixture &fixture) const;
+};
+
+#endif  // NETWORKFIXTURES_H
@@ -1,5 +1,6 @@
 #include "networkmanager.h"
 
+#include "staticsettings.h"
 #include "utils.h"
 
 #ifdef KOBO
@@ -9,10 +10,22 @@
 NetworkManager::NetworkManager(QObject *parent)
     : QObject(parent),
       connected(false),
-      networkManager(new QNetworkAccessManager(this)),
+      ioThread(),
+      connectionMutex(),
+      networkManager(new CustomNetworkAccessManager()),
+      imageProcessingPipeline(new ImageProcessingPipeline(this)),
+      parallelism(),
+      validationCache(),
+      redirects(),
+      rateLimiter(),
+      blobStore(),
+      metrics(),
+      hedging(&metrics),
       settings(nullptr),
       customHeaders(),
-      fileDownloads()
+      fileDownloads(),
+      bufferDownloads(),
+      recentBufferDownloads()
 {
 #ifdef KOBO
     QString sslCertPath = "/mnt/onboard/.adds/qt-linux-5.15.2-kobo/lib/ssl_certs";
@@ -20,6 +33,54 @@ NetworkManager::NetworkManager(QObject *parent)
         sslCertPath = qEnvironmentVariable("QTPATH") + "/lib/ssl_certs";
     loadCertificates(sslCertPath);
 #endif
+
+    // offline benchmarks and tests: record the traffic once, then replay it deterministically
+    if (qEnvironmentVariableIsSet("UMR_NETWORK_RECORD"))
+        networkManager->fixtures()->setMode(NetworkFixtures::Record,
+                                            qEnvironmentVariable("UMR_NETWORK_RECORD"));
+    else if (qEnvironmentVariableIsSet("UMR_NETWORK_REPLAY"))
+        networkManager->fixtures()->setMode(NetworkFixtures::Replay, qEnvironmentVariable("UMR_NETWORK_REPLAY"),
+                                            qEnvironmentVariableIsSet("UMR_NETWORK_REPLAY_LATENCY"));
+
+    // weak Wi-Fi emulation for desktop builds and benchmarks
+    if (qEnvironmentVariableIsSet("UMR_NETWORK_PROFILE"))
+        networkManager->shaper()->loadProfile(qEnvironmentVariable("UMR_NETWORK_PROFILE"));
+
+    // after a resume the lookups and handshakes run while the first request is still being prepared
+    connect(this, &NetworkManager::connectionStatusChanged, this, [this](bool connected) {
+        if (connected)
+            runOnIoThread([this]() { networkManager->warmupConnections(); });
+    });
+
+    networkManager->moveToThread(&ioThread);
+    connect(&ioThread, &QThread::finished, networkManager, &QObject::deleteLater);
+    ioThread.setObjectName("network");
+    ioThread.start();
+}
+
+NetworkManager::~NetworkManager()
+{
+    ioThread.quit();
+    ioThread.wait();
+}
+
+void NetworkManager::runOnIoThread(const std::function<void()> &call, bool wait) const
+{
+    if (QThread::currentThread() == &ioThread || !ioThread.isRunning())
+        call();
+    else
+        QMetaObject::invokeMethod(networkManager, call,
+                                  wait ? Qt::BlockingQueuedConnection : Qt::QueuedConnection);
+}
+
+void NetworkManager::startJob(DownloadJobBase *job)
+{
+    trackMetrics(job);
+
+    // the job is handed to the io thread before anything runs, files already on disk complete right here
+    job->moveToThread(&ioThread);
+    if (!job->completeLocally())
+        job->start();
 }
 
 QNetworkAccessManager *NetworkManager::networkAccessManager()
@@ -27,8 +88,41 @@ QNetworkAccessManager *NetworkManager::networkAccessManager()
     return this->networkManager;
 }
 
+AdaptiveParallelism *NetworkManager::adaptiveParallelism()
+{
+    return &this->parallelism;
+}
+
+NetworkMetrics *NetworkManager::networkMetrics()
+{
+    return &this->metrics;
+}
+
+TlsSessionCache *NetworkManager::tlsSessionCache()
+{
+    return networkManager->sessionCache();
+}
+
+RedirectCache *NetworkManager::redirectCache()
+{
+    return &this->redirects;
+}
+
+ImageBlobStore *NetworkManager::imageBlobStore()
+{
+    return &this->blobStore;
+}
+
+void NetworkManager::trackMetrics(DownloadJobBase *job)
+{
+    connect(job, &DownloadJobBase::completed, this,
+            [this, job]() { metrics.record(QUrl(job->originalUrl).host(), job->timing); });
+}
+
 bool NetworkManager::connectWifi()
 {
+    QMutexLocker locker(&connectionMutex);
+
 #ifdef KOBO
     if (QNetworkProxy::applicationProxy().type() != QNetworkProxy::NoProxy)
     {
@@ -71,6 +165,8 @@ bool NetworkManager::connectWifi()
 
 bool NetworkManager::disconnectWifi()
 {
+    QMutexLocker locker(&connectionMutex);
+
     if (!connected)
         return true;
 
@@ -82,10 +178,30 @@ bool NetworkManager::disconnectWifi()
 #endif
 
     connected = false;
+    emit connectionStatusChanged(connected);
 
     return true;
 }
 
+bool NetworkManager::hasRunningDownloads() const
+{
+    for (const auto &weak : fileDownloads)
+    {
+        auto job = weak.toStrongRef();
+        if (job && job->isRunning())
+            return true;
+    }
+
+    for (const auto &weak : bufferDownloads)
+    {
+        auto job = weak.toStrongRef();
+        if (job && job->isRunning())
+            return true;
+    }
+
+    return false;
+}
+
 bool NetworkManager::checkInternetConnection()
 {
     bool oldstatus = connected;
@@ -116,17 +232,97 @@ QString NetworkManager::fixUrl(const QString &url)
     return url;
 }
 
+QSharedPointer<DownloadBufferJob> NetworkManager::coalescedBufferDownload(const QString &url, int timeout,
+                                                                          bool revalidate)
+{
+    auto job = recentBufferDownloads.value(url);
+    if (!job)
+    {
+        job = bufferDownloads.value(url).toStrongRef();
+        // only join downloads that are still running, failed ones are started again
+        if (job && !job->isRunning())
+            job.clear();
+    }
+
+    // a download started with other options doesn't answer this request
+    if (job && (job->timeoutMs() != timeout || (job->validationCache != nullptr) != revalidate))
+        job.clear();
+
+    return job;
+}
+
+void NetworkManager::trackBufferDownload(QSharedPointer<DownloadBufferJob> job)
+{
+    auto url = job->originalUrl;
+    bufferDownloads.insert(url, job.toWeakRef());
+
+    QWeakPointer<DownloadBufferJob> weakJob = job.toWeakRef();
+    connect(job.get(), &DownloadJobBase::completed, this, [this, url, weakJob]() {
+        auto completedJob = weakJob.toStrongRef();
+        if (!completedJob)
+            return;
+
+        recentBufferDownloads.insert(url, completedJob);
+        QTimer::singleShot(coalesceMemoTime, this, [this, url, weakJob]() {
+            // a newer download of the same url may have replaced it in the meantime
+            if (recentBufferDownloads.value(url) == weakJob.toStrongRef())
+                recentBufferDownloads.remove(url);
+        });
+    });
+}
+
 QSharedPointer<DownloadStringJob> NetworkManager::downloadAsString(const QString &url, int timeout,
-                                                                   const QByteArray &postData)
+                                                                   const QByteArray &postData, bool revalidate)
 {
     auto urlf = fixUrl(url);
 
+    if (postData.isEmpty())
+    {
+        auto job = coalescedBufferDownload(urlf, timeout, revalidate).dynamicCast<DownloadStringJob>();
+        if (job)
+            return job;
+    }
+
     qDebug() << "Downloading as string:" << urlf;
 
-    auto job = QSharedPointer<DownloadStringJob>(
-        new DownloadStringJob(networkManager, urlf, timeout, postData), &QObject::deleteLater);
+    auto job = QSharedPointer<DownloadStringJob>(new DownloadStringJob(networkManager, urlf, timeout, postData),
+                                                 [this](DownloadStringJob *j) {
+                                                     if (this->bufferDownloads.value(j->originalUrl).isNull())
+                                                         this->bufferDownloads.remove(j->originalUrl);
+                                                     j->deleteLater();
+                                                 });
+
+    if (revalidate)
+        job->validationCache = &validationCache;
+    if (postData.isEmpty())
+        job->redirectCache = &redirects;
 
-    job->start();
+    job->rateLimiter = &rateLimiter;
+    startJob(job.get());
+
+    if (postData.isEmpty())
+        trackBufferDownload(job);
+
+    emit activity();
+    return job;
+}
+
+QSharedPointer<DownloadStringJob> NetworkManager::downloadAndScan(const QString &url,
+                                                                  QSharedPointer<HtmlStreamScanner> scanner,
+                                                                  int timeout)
+{
+    auto urlf = fixUrl(url);
+
+    qDebug() << "Downloading and scanning:" << urlf;
+
+    // never coalesced, the body isn't kept for others to read
+    auto job = QSharedPointer<DownloadStringJob>(new DownloadStringJob(networkManager, urlf, timeout),
+                                                 [](DownloadStringJob *j) { j->deleteLater(); });
+    job->scanner = scanner;
+    job->redirectCache = &redirects;
+
+    job->rateLimiter = &rateLimiter;
+    startJob(job.get());
 
     emit activity();
     return job;
@@ -137,12 +333,31 @@ QSharedPointer<DownloadBufferJob> NetworkManager::downloadToBuffer(const QString
 {
     auto urlf = fixUrl(url);
 
+    // a string download of the same url serves buffer requests as well
+    if (postData.isEmpty())
+    {
+        auto job = coalescedBufferDownload(urlf, timeout, false);
+        if (job)
+            return job;
+    }
+
     qDebug() << "Downloading to buffer:" << urlf;
 
-    auto job = QSharedPointer<DownloadBufferJob>(
-        new DownloadBufferJob(networkManager, urlf, timeout, postData), &QObject::deleteLater);
+    auto job = QSharedPointer<DownloadBufferJob>(new DownloadBufferJob(networkManager, urlf, timeout, postData),
+                                                 [this](DownloadBufferJob *j) {
+                                                     if (this->bufferDownloads.value(j->originalUrl).isNull())
+                                                         this->bufferDownloads.remove(j->originalUrl);
+                                                     j->deleteLater();
+                                                 });
 
-    job->start();
+    if (postData.isEmpty())
+        job->redirectCache = &redirects;
+
+    job->rateLimiter = &rateLimiter;
+    startJob(job.get());
+
+    if (postData.isEmpty())
+        trackBufferDownload(job);
 
     emit activity();
     return job;
@@ -156,7 +371,15 @@ QSharedPointer<DownloadFileJob> NetworkManager::downloadAsFile(const QString &ur
     {
         auto job = fileDownloads.value(urlf).toStrongRef();
         if (job)
+        {
+            // a failed or aborted job is still cached while someone holds it, retry it for the new request
+            if (!job->isRunning() && !job->isCompleted)
+            {
+                job->resetRetries();
+                job->restart();
+            }
             return job;
+        }
         else
             fileDownloads.remove(urlf);
     }
@@ -169,7 +392,9 @@ QSharedPointer<DownloadFileJob> NetworkManager::downloadAsFile(const QString &ur
                                                    j->deleteLater();
                                                });
 
-    job->start();
+    job->redirectCache = &redirects;
+    job->rateLimiter = &rateLimiter;
+    startJob(job.get());
 
     fileDownloads.insert(urlf, job.toWeakRef());
 
@@ -178,22 +403,31 @@ QSharedPointer<DownloadFileJob> NetworkManager::downloadAsFile(const QString &ur
 }
 
 QSharedPointer<DownloadFileJob> NetworkManager::downloadAsScaledImage(const QString &url,
-                                                                      const QString &localPath)
+                                                                      const QString &localPath,
+                                                                      const QString &mirrorUrl)
 {
     QString urlf;
     EncryptionDescriptor ed;
+    double variantArea = 0;
     if (url.contains('|'))
     {
         auto split = url.split('|');
         urlf = split[0];
 
-        if (split[1].startsWith("xor:"))
+        for (const auto &option : split.mid(1))
         {
-            ed.type = XorEncryption;
-            ed.key = hexstr2array(split[1].mid(4));
+            if (option.startsWith("xor:"))
+            {
+                ed.type = XorEncryption;
+                ed.key = hexstr2array(option.mid(4));
+            }
+            else if (option.startsWith("area:"))
+            {
+                variantArea = option.mid(5).toDouble();
+            }
+            else
+                qDebug() << "Error: Encryption not supported!";
         }
-        else
-            qDebug() << "Error: Encryption not supported!";
     }
     else
         urlf = url;
@@ -204,7 +438,15 @@ QSharedPointer<DownloadFileJob> NetworkManager::downloadAsScaledImage(const QStr
     {
         auto job = qSharedPointerCast<DownloadScaledImageJob>(fileDownloads.value(urlf).toStrongRef());
         if (job)
+        {
+            // a failed or aborted job is still cached while someone holds it, retry it for the new request
+            if (!job->isRunning() && !job->isCompleted)
+            {
+                job->resetRetries();
+                job->restart();
+            }
             return job;
+        }
         else
             fileDownloads.remove(urlf);
     }
@@ -218,23 +460,31 @@ QSharedPointer<DownloadFileJob> NetworkManager::downloadAsScaledImage(const QStr
             applicableCustomHeaders.append(std::tuple<const char *, const char *>(name, value));
 
     auto job = QSharedPointer<DownloadFileJob>(
-        new DownloadScaledImageJob(networkManager, urlf, localPath, imageRescaleSize, settings,
-                                   applicableCustomHeaders, ed),
+        new DownloadScaledImageJob(networkManager, urlf, localPath, imageProcessingParameters(),
+                                   imageProcessingPipeline, applicableCustomHeaders, ed),
         [this](DownloadScaledImageJob *j) {
             this->fileDownloads.remove(j->originalUrl);
             j->deleteLater();
         });
 
-    job->start();
+    auto sjob = qSharedPointerCast<DownloadScaledImageJob>(job);
+    sjob->hedging = &hedging;
+    sjob->variantArea = variantArea;
+    sjob->blobStore = &blobStore;
+    if (!mirrorUrl.isEmpty())
+        sjob->mirrorUrl = fixUrl(mirrorUrl);
+
+    job->redirectCache = &redirects;
+    job->rateLimiter = &rateLimiter;
+    startJob(job.get());
 
     fileDownloads.insert(urlf, job.toWeakRef());
 
     emit activity();
-    auto sjob = qSharedPointerCast<DownloadScaledImageJob>(job);
-    connect(sjob.get(), &DownloadScaledImageJob::completed, this, [sjob, this]() mutable {
+    // not holding a reference, a job nobody waits for anymore is deleted and thereby aborted
+    connect(sjob.get(), &DownloadScaledImageJob::completed, this, [this, sjob = sjob.get()]() {
         if (sjob->resultImage)
             emit downloadedImage(sjob->filepath, {sjob->resultImage});
-        sjob.clear();
     });
     return job;
 }
@@ -245,13 +495,32 @@ void NetworkManager::setDownloadSettings(const QSize &size, Settings *settings)
     this->settings = settings;
 }
 
+ImageProcessingParameters NetworkManager::imageProcessingParameters() const
+{
+    // the settings belong to the gui thread, the jobs and the pipeline only get a copy
+    ImageProcessingParameters parameters;
+    parameters.screenSize = imageRescaleSize;
+    parameters.doublePageMode = settings->doublePageMode;
+    parameters.trim = settings->trimPages;
+    parameters.manhwaMode = settings->manhwaMode;
+    parameters.useSWDither = settings->ditheringMode == SWHWDithering;
+
+    return parameters;
+}
+
+QSize NetworkManager::imageSize() const
+{
+    return imageRescaleSize;
+}
+
 void NetworkManager::addCookie(const QString &domain, const char *key, const char *value)
 {
     QNetworkCookie c = QNetworkCookie(QByteArray(key), QByteArray(value));
     c.setDomain(domain);
     c.setExpirationDate(QDateTime::currentDateTime().addDays(1));
 
-    networkManager->cookieJar()->insertCookie(c);
+    // queued in front of the requests that need it
+    runOnIoThread([this, c]() { networkManager->cookieJar()->insertCookie(c); });
 }
 
 void NetworkManager::addSetCustomRequestHeader(const QString &domain, const char *key, const char *value)
@@ -259,12 +528,78 @@ void NetworkManager::addSetCustomRequestHeader(const QString &domain, const char
     customHeaders.append({domain, key, value});
 }
 
+void NetworkManager::setHostConnectionPolicy(const QString &domain, const HostConnectionPolicy &policy)
+{
+    networkManager->setHostPolicy(domain, policy);
+}
+
+void NetworkManager::setHostRateLimit(const QString &domain, const RateLimit &limit)
+{
+    rateLimiter.setLimit(domain, limit);
+}
+
+HostConnectionPolicy NetworkManager::hostConnectionPolicy(const QString &host) const
+{
+    return networkManager->hostPolicy(host);
+}
+
+QString NetworkManager::connectionDiagnostics(const QString &host) const
+{
+    auto stats = networkManager->hostStats(host);
+
+    return QString("%1 requests, %2 connections, %3% reused, %4 over http2")
+        .arg(stats.requests)
+        .arg(stats.connectionsOpened)
+        .arg(qRound(stats.reuseRatio() * 100))
+        .arg(stats.http2Responses);
+}
+
+// parsing the pem bundle takes a while on the Kobo, the parsed certificates are cached as der
+// and reused as long as the bundle doesn't change
+static QList<QSslCertificate> loadCaCertificates(const QString &pemPath)
+{
+    QFileInfo pem(pemPath);
+    auto stamp = QString("%1-%2").arg(pem.size()).arg(pem.lastModified().toMSecsSinceEpoch());
+
+    QFile cache(CONF.cacheDir + "cacert.der");
+    if (cache.open(QIODevice::ReadOnly))
+    {
+        QString cachedStamp;
+        QByteArray der;
+        QDataStream in(&cache);
+        in >> cachedStamp >> der;
+        cache.close();
+
+        if (in.status() == QDataStream::Ok && cachedStamp == stamp)
+        {
+            auto certificates = QSslCertificate::fromData(der, QSsl::Der);
+            if (certificates.size() != 0)
+                return certificates;
+        }
+    }
+
+    auto certificates = QSslCertificate::fromPath(pemPath, QSsl::Pem);
+
+    if (certificates.size() != 0 && cache.open(QIODevice::WriteOnly))
+    {
+        QByteArray der;
+        for (const auto &certificate : qAsConst(certificates))
+            der.append(certificate.toDer());
+
+        QDataStream out(&cache);
+        out << stamp << der;
+        cache.close();
+    }
+
+    return certificates;
+}
+
 void NetworkManager::loadCertificates(const QString &certsPath)
 {
     auto sslConfig = QSslConfiguration::defaultConfiguration();
     sslConfig.setProtocol(QSsl::AnyProtocol);
 
-    QList<QSslCertificate> caCertificates = QSslCertificate::fromPath(certsPath + "/cacert.pem", QSsl::Pem);
+    QList<QSslCertificate> caCertificates = loadCaCertificates(certsPath + "/cacert.pem");
     if (caCertificates.size() != 0)
     {
         sslConfig.setCaCertificates(caCertificates);
@@ -280,10 +615,20 @@ void NetworkManager::loadCertificates(const QString &certsPath)
 bool NetworkManager::urlExists(const QString &url)
 {
     QNetworkRequest request(url);
-
-    auto reply = networkManager->head(request);
-
-    awaitSignal(reply, {SIGNAL(finished())}, 2000);
+    QEventLoop loop;
+    QNetworkReply *reply = nullptr;
+
+    // connected before the io thread gets to the reply, so the end can't be missed
+    runOnIoThread(
+        [this, &request, &reply, &loop]() {
+            reply = networkManager->head(request);
+            QObject::connect(reply, &QNetworkReply::finished, &loop, &QEventLoop::quit);
+        },
+        true);
+
+    QTimer::singleShot(2000, &loop, &QEventLoop::quit);
+    if (!reply->isFinished())
+        loop.exec();
 
     bool result = false;
     int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
@@ -1,8 +1,12 @@
 #ifndef DOWNLOADMANAGER_H
 #define DOWNLOADMANAGER_H
 
+#include <QMutex>
 #include <QNetworkReply>
+#include <atomic>
 
+#include "adaptiveparallelism.h"
+#include "customnetworkaccessmanager.h"
 #include "downloadbufferjob.h"
 #include "downloadfilejob.h"
 #include "downloadimageandrescalejob.h"
@@ -15,29 +19,48 @@ class NetworkManager : public QObject
 
 public:
     explicit NetworkManager(QObject *parent = nullptr);
+    ~NetworkManager();
 
+    // lives on the network thread, requests must be made from there
     QNetworkAccessManager *networkAccessManager();
+    AdaptiveParallelism *adaptiveParallelism();
+    NetworkMetrics *networkMetrics();
+    TlsSessionCache *tlsSessionCache();
+    RedirectCache *redirectCache();
+    ImageBlobStore *imageBlobStore();
 
     QSharedPointer<DownloadStringJob> downloadAsString(const QString &url, int timeout = 6000,
-                                                       const QByteArray &postData = QByteArray());
+                                                       const QByteArray &postData = QByteArray(),
+                                                       bool revalidate = false);
+    QSharedPointer<DownloadStringJob> downloadAndScan(const QString &url,
+                                                      QSharedPointer<HtmlStreamScanner> scanner,
+                                                      int timeout = 6000);
     QSharedPointer<DownloadBufferJob> downloadToBuffer(const QString &url, int timeout = 6000,
                                                        const QByteArray &postData = QByteArray());
     QSharedPointer<DownloadFileJob> downloadAsFile(const QString &url, const QString &localPath);
-    QSharedPointer<DownloadFileJob> downloadAsScaledImage(const QString &url, const QString &localPath);
+    QSharedPointer<DownloadFileJob> downloadAsScaledImage(const QString &url, const QString &localPath,
+                                                          const QString &mirrorUrl = QString());
 
     void setDownloadSettings(const QSize &size, Settings *settings);
+    QSize imageSize() const;
 
     void addCookie(const QString &domain, const char *key, const char *value);
     void addSetCustomRequestHeader(const QString &domain, const char *key, const char *value);
+    void setHostConnectionPolicy(const QString &domain, const HostConnectionPolicy &policy);
+    HostConnectionPolicy hostConnectionPolicy(const QString &host) const;
+    void setHostRateLimit(const QString &domain, const RateLimit &limit);
+    QString connectionDiagnostics(const QString &host) const;
 
     bool checkInternetConnection();
     bool connectWifi();
     bool disconnectWifi();
+    bool hasRunningDownloads() const;
 
     static void loadCertificates(const QString &certsPath);
     bool urlExists(const QString &url);
 
-    bool connected;
+    // written by the threads that connect the radio, read everywhere
+    std::atomic<bool> connected;
 
 signals:
     void connectionStatusChanged(bool connected);
@@ -45,7 +68,19 @@ signals:
     void downloadedImage(const QString &path, QSharedPointer<QImage> img);
 
 private:
-    QNetworkAccessManager *networkManager;
+    // replies, redirects, decompression and file writes are handled here instead of the gui thread
+    QThread ioThread;
+    // one connect or disconnect at a time, the burst scheduler and the wifi dialog connect in the background
+    QMutex connectionMutex;
+    CustomNetworkAccessManager *networkManager;
+    ImageProcessingPipeline *imageProcessingPipeline;
+    AdaptiveParallelism parallelism;
+    HttpValidationCache validationCache;
+    RedirectCache redirects;
+    RateLimiter rateLimiter;
+    ImageBlobStore blobStore;
+    NetworkMetrics metrics;
+    RequestHedging hedging;
 
     QSize imageRescaleSize;
     Settings *settings;
@@ -53,7 +88,20 @@ private:
     QList<std::tuple<QString, const char *, const char *>> customHeaders;
 
     QMap<QString, QWeakPointer<DownloadFileJob>> fileDownloads;
+
+    // in-flight GET string/buffer downloads and the ones completed within the last coalesceMemoTime ms,
+    // completed ones are kept alive until they are evicted
+    const int coalesceMemoTime = 5000;
+    QMap<QString, QWeakPointer<DownloadBufferJob>> bufferDownloads;
+    QMap<QString, QSharedPointer<DownloadBufferJob>> recentBufferDownloads;
+
     QString fixUrl(const QString &url);
+    ImageProcessingParameters imageProcessingParameters() const;
+    void runOnIoThread(const std::function<void()> &call, bool wait = false) const;
+    void startJob(DownloadJobBase *job);
+    QSharedPointer<DownloadBufferJob> coalescedBufferDownload(const QString &url, int timeout, bool revalidate);
+    void trackBufferDownload(QSharedPointer<DownloadBufferJob> job);
+    void trackMetrics(DownloadJobBase *job);
 };
 
 #endif  // DOWNLOADMANAGER_H
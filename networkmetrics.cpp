@@ -0,0 +1,169 @@
+#include "networkmetrics.h"
+
+#include <QDebug>
+#include <QtAlgorithms>
+#include <QFile>
+#include <QTextStream>
+
+LatencyHistogram::LatencyHistogram() : buckets(), total(0), maxValue(0), sumValue(0) {}
+
+int LatencyHistogram::bucketIndex(qint64 value)
+{
+    if (value < subBuckets)
+        return (int)value;
+
+    int magnitude = 63 - (int)qCountLeadingZeroBits((quint64)value);
+    int shift = magnitude - subBucketBits;
+
+    // the leading bit is implicit in the magnitude
+    return (shift + 1) * subBuckets + (int)((value >> shift) & (subBuckets - 1));
+}
+
+qint64 LatencyHistogram::bucketValue(int index)
+{
+    if (index < subBuckets)
+        return index;
+
+    int shift = index / subBuckets - 1;
+    qint64 mantissa = subBuckets + index % subBuckets;
+
+    // middle of the bucket
+    return (mantissa << shift) + ((1ll << shift) >> 1);
+}
+
+void LatencyHistogram::record(qint64 value)
+{
+    if (value < 0)
+        return;
+
+    int index = bucketIndex(value);
+    if (index >= buckets.size())
+        buckets.resize(index + 1);
+
+    buckets[index]++;
+    total++;
+    maxValue = qMax(maxValue, value);
+    sumValue += value;
+}
+
+qint64 LatencyHistogram::percentile(double p) const
+{
+    if (total == 0)
+        return 0;
+
+    qint64 rank = qMax<qint64>(1, (qint64)(p / 100.0 * total + 0.5));
+    qint64 seen = 0;
+
+    for (int i = 0; i < buckets.size(); i++)
+    {
+        seen += buckets[i];
+        if (seen >= rank)
+            return qMin(bucketValue(i), maxValue);
+    }
+
+    return maxValue;
+}
+
+qint64 LatencyHistogram::count() const
+{
+    return total;
+}
+
+qint64 LatencyHistogram::sum() const
+{
+    return sumValue;
+}
+
+qint64 LatencyHistogram::max() const
+{
+    return maxValue;
+}
+
+NetworkMetrics::NetworkMetrics() : mutex(), hosts() {}
+
+void NetworkMetrics::recordLocked(const QString &host, const QString &metric, qint64 value)
+{
+    if (value >= 0)
+        hosts[host][metric].record(value);
+}
+
+void NetworkMetrics::record(const QString &host, const QString &metric, qint64 value)
+{
+    QMutexLocker locker(&mutex);
+
+    recordLocked(host, metric, value);
+}
+
+void NetworkMetrics::record(const QString &host, const RequestTiming &timing)
+{
+    QMutexLocker locker(&mutex);
+
+    recordLocked(host, "connect", timing.connect);
+    recordLocked(host, "firstbyte", timing.firstByte);
+    recordLocked(host, "transfer", timing.transfer);
+    recordLocked(host, "total", timing.total);
+    recordLocked(host, "decrypt", timing.decrypt);
+    recordLocked(host, "decode", timing.decode);
+    recordLocked(host, "transform", timing.transform);
+    recordLocked(host, "encode", timing.encode);
+
+    // not durations
+    recordLocked(host, "bytes", timing.bytes);
+    recordLocked(host, "decodedbytes", timing.decodedBytes);
+    recordLocked(host, "redirects", timing.redirects);
+    recordLocked(host, "redirectssaved", timing.redirectsSaved);
+    recordLocked(host, "hedges", timing.hedges);
+    recordLocked(host, "hedgewins", timing.hedgeWins);
+    recordLocked(host, "variantsaved", timing.variantBytesSaved);
+}
+
+qint64 NetworkMetrics::percentile(const QString &host, const QString &metric, double p, qint64 minCount) const
+{
+    QMutexLocker locker(&mutex);
+
+    auto hostit = hosts.find(host);
+    if (hostit == hosts.end())
+        return -1;
+
+    auto metricit = hostit->find(metric);
+    if (metricit == hostit->end() || metricit->count() < minCount)
+        return -1;
+
+    return metricit->percentile(p);
+}
+
+QString NetworkMetrics::summary() const
+{
+    QMutexLocker locker(&mutex);
+
+    QString result;
+    QTextStream out(&result);
+
+    out << "host metric count p50 p95 p99 max sum (us, bytes)\n";
+
+    for (auto host = hosts.begin(); host != hosts.end(); ++host)
+        for (auto metric = host->begin(); metric != host->end(); ++metric)
+            out << host.key() << " " << metric.key() << " " << metric->count() << " "
+                << metric->percentile(50) << " " << metric->percentile(95) << " "
+                << metric->percentile(99) << " " << metric->max() << " " << metric->sum() << "\n";
+
+    return result;
+}
+
+void NetworkMetrics::logSummary() const
+{
+    for (const auto &line : summary().split('\n', Qt::SkipEmptyParts))
+        qDebug().noquote() << line;
+}
+
+bool NetworkMetrics::dump(const QString &path) const
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+        return false;
+
+    file.write(summary().toUtf8());
+    file.close();
+
+    return true;
+}
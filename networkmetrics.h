@@ -0,0 +1,81 @@
+#ifndef NETWORKMETRICS_H
+#define NETWORKMETRICS_H
+
+#include <QMap>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+
+// durations in microseconds, -1 if the phase didn't happen
+struct RequestTiming
+{
+    qint64 connect = -1;  // dns lookup, tcp and tls handshake of a new connection
+    qint64 firstByte = -1;
+    qint64 transfer = -1;
+    qint64 total = -1;
+    qint64 bytes = 0;         // received on the wire, compressed if the server compressed the body
+    qint64 decodedBytes = -1;  // size of the inflated body, string and buffer downloads only
+    int redirects = 0;
+    int redirectsSaved = 0;         // hops skipped by starting at a learned redirect target
+    int hedges = 0;                 // duplicate requests sent for a stalled image
+    int hedgeWins = 0;              // the duplicate answered first
+    qint64 variantBytesSaved = -1;  // estimated, for pages downloaded as a smaller upstream variant
+
+    qint64 decrypt = -1;
+    qint64 decode = -1;
+    qint64 transform = -1;
+    qint64 encode = -1;
+};
+
+// Log-linear histogram in the style of HdrHistogram:
+// each power of two is split into subBuckets buckets, so values are kept with ~3% precision.
+class LatencyHistogram
+{
+public:
+    LatencyHistogram();
+
+    void record(qint64 value);
+    qint64 percentile(double p) const;
+    qint64 count() const;
+    qint64 max() const;
+    qint64 sum() const;
+
+private:
+    static const int subBucketBits = 5;
+    static const int subBuckets = 1 << subBucketBits;
+
+    QVector<quint32> buckets;
+    qint64 total;
+    qint64 maxValue;
+    qint64 sumValue;
+
+    static int bucketIndex(qint64 value);
+    static qint64 bucketValue(int index);
+};
+
+// Per host histograms of the request and image processing phases and the queue wait.
+// The sums of the byte metrics show the bandwidth saved by compression.
+// Thread safe, the summary can be written to the debug log or a file.
+class NetworkMetrics
+{
+public:
+    NetworkMetrics();
+
+    void record(const QString &host, const RequestTiming &timing);
+    void record(const QString &host, const QString &metric, qint64 value);
+
+    // p-th percentile of a metric of host, -1 with less than minCount samples
+    qint64 percentile(const QString &host, const QString &metric, double p, qint64 minCount = 1) const;
+
+    QString summary() const;
+    void logSummary() const;
+    bool dump(const QString &path) const;
+
+private:
+    mutable QMutex mutex;
+    QMap<QString, QMap<QString, LatencyHistogram>> hosts;
+
+    void recordLocked(const QString &host, const QString &metric, qint64 value);
+};
+
+#endif  // NETWORKMETRICS_H
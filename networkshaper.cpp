@@ -0,0 +1,200 @@
+#include "networkshaper.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QSettings>
+#include <QTimer>
+
+NetworkShaper::NetworkShaper()
+    : enabled(false), random(QRandomGenerator::securelySeeded()), defaultProfile(), hostProfiles(), buckets()
+{
+}
+
+static ShapingProfile readProfile(QSettings &ini, const ShapingProfile &base)
+{
+    ShapingProfile profile;
+    profile.rtt = ini.value("rtt", base.rtt).toInt();
+    profile.jitter = ini.value("jitter", base.jitter).toInt();
+    profile.bandwidth = ini.value("bandwidth", base.bandwidth).toLongLong();
+    profile.loss = ini.value("loss", base.loss).toDouble();
+    profile.stall = ini.value("stall", base.stall).toDouble();
+    profile.stallDuration = ini.value("stallDuration", base.stallDuration).toInt();
+
+    return profile;
+}
+
+bool NetworkShaper::loadProfile(const QString &path)
+{
+    if (!QFile::exists(path))
+    {
+        qDebug() << "Network profile not found:" << path;
+        return false;
+    }
+
+    QSettings ini(path, QSettings::IniFormat);
+
+    if (ini.contains("seed"))
+        random.seed(ini.value("seed").toUInt());
+
+    ini.beginGroup("default");
+    defaultProfile = readProfile(ini, ShapingProfile());
+    ini.endGroup();
+
+    hostProfiles.clear();
+    for (const auto &group : ini.childGroups())
+    {
+        if (group == "default")
+            continue;
+
+        ini.beginGroup(group);
+        hostProfiles.append({group, readProfile(ini, defaultProfile)});
+        ini.endGroup();
+    }
+
+    enabled = true;
+    qDebug() << "Emulating network conditions from" << path;
+
+    return true;
+}
+
+bool NetworkShaper::isEnabled() const
+{
+    return enabled;
+}
+
+ShapingProfile NetworkShaper::profile(const QString &host) const
+{
+    for (const auto &p : hostProfiles)
+        if (host == p.first || host.endsWith("." + p.first))
+            return p.second;
+
+    return defaultProfile;
+}
+
+qint64 NetworkShaper::takeTokens(const QString &host, qint64 bandwidth, qint64 wanted)
+{
+    if (bandwidth <= 0)
+        return wanted;
+
+    auto &bucket = buckets[host];
+
+    if (!bucket.refill.isValid())
+        bucket.refill.start();
+
+    // allow bursts of 100 ms worth of data
+    bucket.tokens = qMin(bandwidth * 0.1, bucket.tokens + bandwidth * bucket.refill.restart() / 1000.0);
+
+    qint64 taken = qMin<qint64>(wanted, (qint64)bucket.tokens);
+    bucket.tokens -= taken;
+
+    return taken;
+}
+
+QNetworkReply *NetworkShaper::shape(QNetworkReply *reply, QNetworkAccessManager::Operation op,
+                                    const QNetworkRequest &request, QObject *parent)
+{
+    struct State
+    {
+        QElapsedTimer clock;
+        qint64 firstByteAt = 0;
+        bool lost = false;
+        qint64 stallAfterBytes = -1;
+        qint64 stalledUntil = 0;
+
+        bool headersAvailable = false;
+        bool headersDelivered = false;
+        bool innerFinished = false;
+        QNetworkReply::NetworkError error = QNetworkReply::NoError;
+        QString errorString;
+        qint64 delivered = 0;
+    };
+
+    auto host = request.url().host();
+    auto p = profile(host);
+
+    auto proxy = new BufferedNetworkReply(op, request, parent);
+    reply->setParent(proxy);
+
+    auto state = QSharedPointer<State>::create();
+    state->clock.start();
+    state->firstByteAt = p.rtt + (p.jitter > 0 ? random.bounded(p.jitter + 1) : 0);
+    state->lost = random.generateDouble() < p.loss;
+    if (random.generateDouble() < p.stall)
+        state->stallAfterBytes = random.bounded(64 * 1024);
+
+#if QT_VERSION >= QT_VERSION_CHECK(6, 3, 0)
+    QObject::connect(reply, &QNetworkReply::socketStartedConnecting, proxy,
+                     &QNetworkReply::socketStartedConnecting);
+    QObject::connect(reply, &QNetworkReply::requestSent, proxy, &QNetworkReply::requestSent);
+#endif
+    QObject::connect(reply, &QNetworkReply::encrypted, proxy, &QNetworkReply::encrypted);
+    QObject::connect(reply, &QNetworkReply::sslErrors, proxy, &QNetworkReply::sslErrors);
+    QObject::connect(proxy, &BufferedNetworkReply::abortRequested, reply, &QNetworkReply::abort);
+    QObject::connect(proxy, &BufferedNetworkReply::ignoreSslErrorsRequested, reply,
+                     QOverload<>::of(&QNetworkReply::ignoreSslErrors));
+    QObject::connect(proxy, &BufferedNetworkReply::readBufferSizeChanged, reply,
+                     &QNetworkReply::setReadBufferSize);
+
+    // the body stays in the real reply until it is delivered, its read buffer size throttles the socket
+    QObject::connect(reply, &QNetworkReply::metaDataChanged, proxy, [state]() { state->headersAvailable = true; });
+    QObject::connect(reply, &QNetworkReply::finished, proxy, [state, reply]() {
+        state->error = reply->error();
+        state->errorString = reply->errorString();
+        state->innerFinished = true;
+    });
+
+    auto timer = new QTimer(proxy);
+    QObject::connect(timer, &QTimer::timeout, proxy, [this, state, reply, proxy, timer, host, p]() {
+        auto now = state->clock.elapsed();
+
+        if (proxy->isFinished())
+        {
+            timer->stop();
+            return;
+        }
+
+        if (now < state->firstByteAt || now < state->stalledUntil)
+            return;
+
+        if (state->lost)
+        {
+            QObject::disconnect(reply, nullptr, proxy, nullptr);
+            reply->abort();
+            proxy->finishReply(QNetworkReply::RemoteHostClosedError, "Connection closed (emulated loss)");
+            return;
+        }
+
+        if (!state->headersDelivered && (state->headersAvailable || state->innerFinished))
+        {
+            proxy->copyResponse(reply);
+            state->headersDelivered = true;
+        }
+
+        if (!state->headersDelivered)
+            return;
+
+        auto wanted = qMin(reply->bytesAvailable(), proxy->bufferSpace());
+        if (state->stallAfterBytes >= 0)
+            wanted = qMin(wanted, qMax<qint64>(0, state->stallAfterBytes - state->delivered));
+
+        auto size = takeTokens(host, p.bandwidth, wanted);
+        if (size > 0)
+        {
+            proxy->appendData(reply->read(size));
+            state->delivered += size;
+        }
+
+        if (state->stallAfterBytes >= 0 && state->delivered >= state->stallAfterBytes)
+        {
+            state->stalledUntil = now + p.stallDuration;
+            state->stallAfterBytes = -1;
+            return;
+        }
+
+        if (state->innerFinished && reply->bytesAvailable() == 0)
+            proxy->finishReply(state->error, state->errorString);
+    });
+    timer->start(20);
+
+    return proxy;
+}
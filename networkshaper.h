@@ -0,0 +1,63 @@
+#ifndef NETWORKSHAPER_H
+#define NETWORKSHAPER_H
+
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+
+#include "bufferednetworkreply.h"
+
+struct ShapingProfile
+{
+    int rtt = 0;              // ms until the response starts
+    int jitter = 0;           // ms, added to the rtt at random
+    qint64 bandwidth = 0;     // bytes/s shared by all requests to a host, <= 0 means unlimited
+    double loss = 0;          // probability that a request fails with a dropped connection
+    double stall = 0;         // probability that a response stops in the middle for a while
+    int stallDuration = 0;    // ms
+};
+
+// Emulates slow and lossy networks between the jobs and the real (or replayed) replies.
+// Driven by an ini profile, the [default] group applies to all hosts, groups named after
+// a host suffix override it, a seed makes the random decisions reproducible:
+//
+//   ; Kobo on 2.4 GHz, 1 Mbit
+//   [General]
+//   seed=1
+//   [default]
+//   rtt=120
+//   jitter=80
+//   bandwidth=125000
+//   loss=0.02
+//   stall=0.05
+//   stallDuration=4000
+//   [tokyo-cdn.com]
+//   rtt=300
+class NetworkShaper
+{
+public:
+    NetworkShaper();
+
+    bool loadProfile(const QString &path);
+    bool isEnabled() const;
+
+    QNetworkReply *shape(QNetworkReply *reply, QNetworkAccessManager::Operation op,
+                         const QNetworkRequest &request, QObject *parent);
+
+private:
+    struct HostBucket
+    {
+        double tokens = 0;
+        QElapsedTimer refill;
+    };
+
+    bool enabled;
+    QRandomGenerator random;
+    ShapingProfile defaultProfile;
+    QList<QPair<QString, ShapingProfile>> hostProfiles;
+    QMap<QString, HostBucket> buckets;
+
+    ShapingProfile profile(const QString &host) const;
+    qint64 takeTokens(const QString &host, qint64 bandwidth, qint64 wanted);
+};
+
+#endif  // NETWORKSHAPER_H
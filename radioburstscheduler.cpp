@@ -0,0 +1,115 @@
+#include "radioburstscheduler.h"
+
+#include <QtConcurrent/QtConcurrent>
+
+RadioBurstScheduler::RadioBurstScheduler(NetworkManager *networkManager, QObject *parent)
+    : QObject(parent),
+      networkManager(networkManager),
+      tasks(),
+      gatherTimer(),
+      idleTimer(),
+      connecting(),
+      bursting(false)
+{
+    // tasks scheduled in the same event loop pass are run together
+    gatherTimer.setSingleShot(true);
+    gatherTimer.setInterval(0);
+    connect(&gatherTimer, &QTimer::timeout, this, &RadioBurstScheduler::runTasks);
+
+    idleTimer.setSingleShot(true);
+    idleTimer.setInterval(CONF.radioIdleOffSeconds * 1000);
+    connect(&idleTimer, &QTimer::timeout, this, &RadioBurstScheduler::idle);
+
+    connect(networkManager, &NetworkManager::activity, this, [this]() {
+        if (bursting)
+            idleTimer.start();
+    });
+    connect(networkManager, &NetworkManager::connectionStatusChanged, this, [this](bool connected) {
+        if (connected)
+            runTasks();
+    });
+}
+
+RadioBurstScheduler::~RadioBurstScheduler()
+{
+    if (connecting.isRunning())
+        connecting.waitForFinished();
+}
+
+void RadioBurstScheduler::schedule(const QString &key, std::function<void()> task)
+{
+    tasks.insert(key, task);
+
+    if (networkManager->connected)
+        gatherTimer.start();
+}
+
+bool RadioBurstScheduler::cancel(const QString &key)
+{
+    return tasks.remove(key) > 0;
+}
+
+void RadioBurstScheduler::burst()
+{
+    if (networkManager->connected)
+    {
+        runTasks();
+        return;
+    }
+
+    // connecting takes seconds on the Kobo, the tasks are run once the connection is reported
+    if (!connecting.isRunning())
+        connecting = QtConcurrent::run([this]() {
+            if (!networkManager->connectWifi())
+                emit connectFailed();
+        });
+}
+
+bool RadioBurstScheduler::isBursting() const
+{
+    return bursting;
+}
+
+int RadioBurstScheduler::pendingTasks() const
+{
+    return tasks.count();
+}
+
+void RadioBurstScheduler::runTasks()
+{
+    if (!networkManager->connected)
+        return;
+
+    if (!bursting)
+    {
+        bursting = true;
+        qDebug() << "Network burst started," << tasks.count() << "tasks pending";
+        emit burstStarted();
+    }
+
+    // tasks may schedule new ones
+    auto pending = tasks;
+    tasks.clear();
+    for (const auto &task : qAsConst(pending))
+        task();
+
+    idleTimer.start();
+}
+
+void RadioBurstScheduler::idle()
+{
+    if (!tasks.isEmpty() || networkManager->hasRunningDownloads())
+    {
+        idleTimer.start();
+        return;
+    }
+
+    bursting = false;
+    qDebug() << "Network burst finished";
+    emit burstFinished();
+
+#ifdef KOBO
+    if (networkManager->connected)
+        networkManager->disconnectWifi();
+#endif
+}
@@ -0,0 +1,51 @@
+#ifndef RADIOBURSTSCHEDULER_H
+#define RADIOBURSTSCHEDULER_H
+
+#include <QFuture>
+#include <QTimer>
+
+#include "networkmanager.h"
+#include "staticsettings.h"
+
+// Gathers background network work (the visible page and the reading horizon, including the page
+// lists of the chapters ahead) so the Wi-Fi radio is only up in short bursts. Tasks wait while the radio is down and all of them
+// run at once when it comes up. Once no download was active for CONF.radioIdleOffSeconds
+// the burst ends and on the Kobo the radio is dropped again.
+class RadioBurstScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit RadioBurstScheduler(NetworkManager *networkManager, QObject *parent = nullptr);
+    ~RadioBurstScheduler();
+
+    // a task replaces the pending one with the same key
+    void schedule(const QString &key, std::function<void()> task);
+    // returns whether the task was still pending
+    bool cancel(const QString &key);
+
+    // brings the radio up if needed and runs all pending tasks
+    void burst();
+
+    bool isBursting() const;
+    int pendingTasks() const;
+
+signals:
+    void burstStarted();
+    void burstFinished();
+    // the radio couldn't be brought up, the tasks stay pending for the next burst
+    void connectFailed();
+
+private:
+    NetworkManager *networkManager;
+    QMap<QString, std::function<void()>> tasks;
+    QTimer gatherTimer;
+    QTimer idleTimer;
+    QFuture<void> connecting;
+    bool bursting;
+
+    void runTasks();
+    void idle();
+};
+
+#endif  // RADIOBURSTSCHEDULER_H
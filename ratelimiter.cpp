@@ -0,0 +1,143 @@
+#include "ratelimiter.h"
+
+#include <QDebug>
+
+// the domain itself and its subdomains, a domain with a leading dot only matches the subdomains
+static bool matchesDomain(const QString &host, const QString &domain)
+{
+    if (domain.startsWith('.'))
+        return host.endsWith(domain);
+
+    return host == domain || host.endsWith("." + domain);
+}
+
+RateLimiter::RateLimiter() : mutex(), limits(), hosts(), clock()
+{
+    clock.start();
+}
+
+void RateLimiter::setLimit(const QString &domain, const RateLimit &limit)
+{
+    QMutexLocker locker(&mutex);
+
+    for (auto &l : limits)
+    {
+        if (l.first == domain)
+        {
+            l.second = limit;
+            return;
+        }
+    }
+
+    limits.append({domain, limit});
+}
+
+HostRateBucket &RateLimiter::bucket(const QString &host)
+{
+    auto it = hosts.find(host);
+    if (it != hosts.end())
+        return *it;
+
+    HostRateBucket bucket;
+    for (const auto &l : qAsConst(limits))
+    {
+        if (matchesDomain(host, l.first))
+        {
+            bucket.ceiling = l.second.requestsPerSecond;
+            bucket.rate = l.second.requestsPerSecond;
+            bucket.burst = qMax(1, l.second.burst);
+            bucket.tokens = bucket.burst;
+            break;
+        }
+    }
+    bucket.lastRefill = clock.elapsed();
+    bucket.windowStart = bucket.lastRefill;
+
+    return *hosts.insert(host, bucket);
+}
+
+void RateLimiter::refill(HostRateBucket &bucket, qint64 now)
+{
+    bucket.tokens = qMin(bucket.burst, bucket.tokens + (now - bucket.lastRefill) * bucket.rate / 1000.0);
+    bucket.lastRefill = now;
+}
+
+int RateLimiter::reserve(const QString &host)
+{
+    QMutexLocker locker(&mutex);
+
+    auto &b = bucket(host);
+    auto now = clock.elapsed();
+
+    if (now - b.windowStart > observationWindow)
+    {
+        b.windowStart = now;
+        b.windowCount = 0;
+    }
+    b.windowCount++;
+
+    qint64 wait = qMax<qint64>(0, b.pausedUntil - now);
+    if (b.rate <= 0)
+        return wait;
+
+    // the tokens go negative while requests are waiting for their turn
+    refill(b, now);
+    b.tokens -= 1;
+    if (b.tokens < 0)
+        wait = qMax<qint64>(wait, -b.tokens * 1000.0 / b.rate);
+
+    return wait;
+}
+
+int RateLimiter::pause(const QString &host) const
+{
+    QMutexLocker locker(&mutex);
+
+    auto it = hosts.find(host);
+    if (it == hosts.end())
+        return 0;
+
+    return qMax<qint64>(0, it->pausedUntil - clock.elapsed());
+}
+
+void RateLimiter::throttle(const QString &host, int retryAfter)
+{
+    QMutexLocker locker(&mutex);
+
+    auto &b = bucket(host);
+    auto now = clock.elapsed();
+
+    b.pausedUntil = qMax(b.pausedUntil, now + (retryAfter > 0 ? retryAfter : defaultPause));
+
+    // the requests in flight all run into the limit, only the first answer lowers the rate
+    if (b.lastDecrease >= 0 && now - b.lastDecrease < 1000)
+        return;
+    b.lastDecrease = now;
+
+    refill(b, now);
+    if (b.rate > 0)
+    {
+        b.rate = qMax(minRate, b.rate * decreaseFactor);
+    }
+    else
+    {
+        double observed = b.windowCount * 1000.0 / qMax<qint64>(1000, now - b.windowStart);
+        b.rate = qMax(minRate, observed * decreaseFactor);
+    }
+    b.tokens = qMin(b.tokens, 0.0);
+
+    qDebug() << "Rate limited by" << host << "now sending" << b.rate << "requests/s";
+}
+
+void RateLimiter::succeeded(const QString &host)
+{
+    QMutexLocker locker(&mutex);
+
+    auto it = hosts.find(host);
+    if (it == hosts.end() || it->rate <= 0)
+        return;
+
+    it->rate += increaseStep;
+    if (it->ceiling > 0)
+        it->rate = qMin(it->ceiling, it->rate);
+}
@@ -0,0 +1,72 @@
+#ifndef RATELIMITER_H
+#define RATELIMITER_H
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QMap>
+#include <QMutex>
+#include <QPair>
+#include <QString>
+
+struct RateLimit
+{
+    RateLimit(double requestsPerSecond = 0, int burst = 1) : requestsPerSecond(requestsPerSecond), burst(burst)
+    {
+    }
+
+    double requestsPerSecond;  // 0 means no limit
+    int burst;
+};
+
+struct HostRateBucket
+{
+    double ceiling = 0;  // declared limit, 0 if none was declared
+    double rate = 0;     // current limit, 0 until the host asked to slow down
+    double burst = 1;
+    double tokens = 1;
+    qint64 lastRefill = 0;
+    qint64 pausedUntil = 0;
+    qint64 lastDecrease = -1;
+
+    // requests sent in the current observation window, gives the rate that was too fast
+    qint64 windowStart = 0;
+    int windowCount = 0;
+};
+
+// Token bucket per host for the requests sent to it.
+// Sources declare the known limits of their hosts, hosts without one are only limited once
+// they answered 429 or 503. Such an answer pauses the host for its Retry-After and lowers the
+// rate, every success raises it a little again (up to the declared limit), so the sustained rate
+// settles just below the one the server tolerates. Thread safe.
+class RateLimiter
+{
+public:
+    RateLimiter();
+
+    void setLimit(const QString &domain, const RateLimit &limit);
+
+    // takes a request slot of host, returns the ms to wait before the request may be sent
+    int reserve(const QString &host);
+    // ms left until the host accepts requests again
+    int pause(const QString &host) const;
+
+    void throttle(const QString &host, int retryAfter);
+    void succeeded(const QString &host);
+
+private:
+    const double decreaseFactor = 0.7;
+    const double increaseStep = 0.02;
+    const double minRate = 0.2;
+    const int defaultPause = 2000;
+    const int observationWindow = 10000;
+
+    mutable QMutex mutex;
+    QList<QPair<QString, RateLimit>> limits;
+    QMap<QString, HostRateBucket> hosts;
+    QElapsedTimer clock;
+
+    HostRateBucket &bucket(const QString &host);
+    void refill(HostRateBucket &bucket, qint64 now);
+};
+
+#endif  // RATELIMITER_H
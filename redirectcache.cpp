@@ -0,0 +1,163 @@
+#include "redirectcache.h"
+
+#include "staticsettings.h"
+
+RedirectCache::RedirectCache() : mutex(), urls(), origins(), dirty(false)
+{
+    deserialize();
+}
+
+RedirectCache::~RedirectCache()
+{
+    serialize();
+}
+
+QString RedirectCache::originOf(const QUrl &url)
+{
+    return url.adjusted(QUrl::RemoveUserInfo | QUrl::RemovePath | QUrl::RemoveQuery | QUrl::RemoveFragment)
+        .toString();
+}
+
+QString RedirectCache::resolve(const QString &url)
+{
+    QMutexLocker locker(&mutex);
+
+    auto now = QDateTime::currentDateTimeUtc();
+
+    auto it = urls.find(url);
+    if (it != urls.end())
+    {
+        if (it->expires > now)
+        {
+            it->lastUsed = now;
+            return it->target;
+        }
+
+        urls.erase(it);
+        dirty = true;
+    }
+
+    QUrl qurl(url);
+    auto oit = origins.find(originOf(qurl));
+    if (oit != origins.end())
+    {
+        if (oit->expires > now)
+        {
+            oit->lastUsed = now;
+
+            QUrl origin(oit->target);
+            qurl.setScheme(origin.scheme());
+            qurl.setHost(origin.host());
+            qurl.setPort(origin.port());
+            return qurl.toString();
+        }
+
+        origins.erase(oit);
+        dirty = true;
+    }
+
+    return QString();
+}
+
+void RedirectCache::learn(const QString &from, const QString &to, bool permanent)
+{
+    QMutexLocker locker(&mutex);
+
+    if (from == to)
+        return;
+
+    auto now = QDateTime::currentDateTimeUtc();
+    RedirectEntry entry{to, now.addSecs(permanent ? permanentLifetime : temporaryLifetime), now};
+
+    QUrl fromUrl(from);
+    QUrl toUrl(to);
+    auto fromOrigin = originOf(fromUrl);
+    auto toOrigin = originOf(toUrl);
+
+    // a temporary bounce says nothing about the other urls of the origin
+    if (permanent && fromOrigin != toOrigin && fromUrl.path() == toUrl.path() &&
+        fromUrl.query() == toUrl.query())
+    {
+        entry.target = toOrigin;
+        origins.insert(fromOrigin, entry);
+        evict(origins, maxEntries);
+    }
+    else
+    {
+        urls.insert(from, entry);
+        evict(urls, maxEntries);
+    }
+
+    dirty = true;
+}
+
+void RedirectCache::invalidate(const QString &url)
+{
+    QMutexLocker locker(&mutex);
+
+    int removed = urls.remove(url) + origins.remove(originOf(QUrl(url)));
+    if (removed > 0)
+        dirty = true;
+}
+
+void RedirectCache::evict(QMap<QString, RedirectEntry> &entries, int maxEntries)
+{
+    while (entries.count() > maxEntries)
+    {
+        auto oldest = entries.begin();
+        for (auto it = entries.begin(); it != entries.end(); ++it)
+            if (it->lastUsed < oldest->lastUsed)
+                oldest = it;
+        entries.erase(oldest);
+    }
+}
+
+void RedirectCache::deserialize()
+{
+    QFile file(CONF.cacheDir + "redirects.dat");
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    QDataStream in(&file);
+    auto now = QDateTime::currentDateTimeUtc();
+
+    for (auto entries : {&urls, &origins})
+    {
+        int count = 0;
+        in >> count;
+
+        for (int i = 0; i < count && in.status() == QDataStream::Ok; i++)
+        {
+            QString key;
+            RedirectEntry entry;
+            in >> key >> entry.target >> entry.expires >> entry.lastUsed;
+
+            if (in.status() == QDataStream::Ok && entry.expires > now)
+                entries->insert(key, entry);
+        }
+    }
+    file.close();
+}
+
+void RedirectCache::serialize()
+{
+    QMutexLocker locker(&mutex);
+
+    if (!dirty)
+        return;
+
+    QFile file(CONF.cacheDir + "redirects.dat");
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+
+    QDataStream out(&file);
+    for (auto entries : {&urls, &origins})
+    {
+        out << entries->count();
+        for (auto it = entries->begin(); it != entries->end(); ++it)
+            out << it.key() << it->target << it->expires << it->lastUsed;
+    }
+    file.close();
+
+    dirty = false;
+}
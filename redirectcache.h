@@ -0,0 +1,50 @@
+#ifndef REDIRECTCACHE_H
+#define REDIRECTCACHE_H
+
+#include <QDateTime>
+#include <QMap>
+#include <QMutex>
+#include <QUrl>
+
+struct RedirectEntry
+{
+    QString target;
+    QDateTime expires;
+    QDateTime lastUsed;
+};
+
+// Redirects learned from finished downloads, so later requests go straight to the final location.
+// A permanent redirect that only moved to another origin (scheme, host and port) and kept path and
+// query is learned for the whole origin, this covers image hosts that moved every request to a CDN.
+// Any other redirect is learned for its url. Kept in the cache dir, thread safe.
+class RedirectCache
+{
+public:
+    RedirectCache();
+    ~RedirectCache();
+
+    // returns the learned location of url, or an empty string
+    QString resolve(const QString &url);
+    void learn(const QString &from, const QString &to, bool permanent);
+    // drops the entries that resolved url
+    void invalidate(const QString &url);
+
+    void serialize();
+
+private:
+    const int maxEntries = 512;
+    const int permanentLifetime = 7 * 24 * 3600;
+    const int temporaryLifetime = 3600;
+
+    QMutex mutex;
+    QMap<QString, RedirectEntry> urls;
+    QMap<QString, RedirectEntry> origins;
+    bool dirty;
+
+    static QString originOf(const QUrl &url);
+    static void evict(QMap<QString, RedirectEntry> &entries, int maxEntries);
+
+    void deserialize();
+};
+
+#endif  // REDIRECTCACHE_H
@@ -0,0 +1,29 @@
+#include "requesthedging.h"
+
+#include <QtGlobal>
+
+RequestHedging::RequestHedging(NetworkMetrics *metrics) : metrics(metrics), budget(1.0) {}
+
+int RequestHedging::delay(const QString &host) const
+{
+    // stay below the 3 s a reader waits for a page
+    auto p95 = metrics->percentile(host, "firstbyte", 95, minSamples);
+    if (p95 < 0)
+        return defaultDelay;
+
+    return qBound<int>(minDelay, p95 / 1000, maxDelay);
+}
+
+void RequestHedging::requestStarted()
+{
+    budget = qMin(maxBudget, budget + budgetShare);
+}
+
+bool RequestHedging::acquire()
+{
+    if (budget < 1.0)
+        return false;
+
+    budget -= 1.0;
+    return true;
+}
@@ -0,0 +1,33 @@
+#ifndef REQUESTHEDGING_H
+#define REQUESTHEDGING_H
+
+#include "networkmetrics.h"
+
+// Decides when a stalled image request gets a duplicate.
+// The duplicate is sent once the request waited the p95 time to first byte seen for its host,
+// a budget earned per request caps the duplicates at a small share of the traffic.
+class RequestHedging
+{
+public:
+    explicit RequestHedging(NetworkMetrics *metrics);
+
+    // ms to wait for the first byte before hedging a request to host
+    int delay(const QString &host) const;
+
+    void requestStarted();
+    // takes a hedge from the budget, false if it is used up
+    bool acquire();
+
+private:
+    const double budgetShare = 0.05;
+    const double maxBudget = 2.0;
+    const int minSamples = 20;
+    const int minDelay = 300;
+    const int maxDelay = 2000;
+    const int defaultDelay = 1500;
+
+    NetworkMetrics *metrics;
+    double budget;
+};
+
+#endif  // REQUESTHEDGING_H
@@ -0,0 +1,72 @@
+#include "retrypolicy.h"
+
+#include <QDateTime>
+#include <QRandomGenerator>
+
+bool RetryPolicy::isRetryable(bool idempotent, int httpStatus, QNetworkReply::NetworkError error) const
+{
+    if (!idempotent)
+        return false;
+
+    if (httpStatus == 429 || httpStatus == 500 || httpStatus == 502 || httpStatus == 503 ||
+        httpStatus == 504)
+        return true;
+
+    // other http errors won't go away by asking again
+    if (httpStatus >= 400)
+        return false;
+
+    switch (error)
+    {
+        case QNetworkReply::ConnectionRefusedError:
+        case QNetworkReply::RemoteHostClosedError:
+        case QNetworkReply::HostNotFoundError:
+        case QNetworkReply::TimeoutError:
+        case QNetworkReply::TemporaryNetworkFailureError:
+        case QNetworkReply::NetworkSessionFailedError:
+        case QNetworkReply::UnknownNetworkError:
+        case QNetworkReply::ProxyTimeoutError:
+        case QNetworkReply::InternalServerError:
+        case QNetworkReply::ServiceUnavailableError:
+        case QNetworkReply::UnknownServerError:
+            return true;
+        default:
+            return false;
+    }
+}
+
+int RetryPolicy::delay(int retry, int retryAfter) const
+{
+    if (retryAfter >= 0)
+        return retryAfter;
+
+    int ceiling = (int)qMin<qint64>(maxDelay, (qint64)baseDelay << qMin(retry, 20));
+
+    // full jitter spreads out the retries of downloads that failed at the same time
+    return QRandomGenerator::global()->bounded(ceiling + 1);
+}
+
+bool RetryPolicy::allowsRetry(int retry, qint64 elapsed, int delay) const
+{
+    if (retry >= maxRetries)
+        return false;
+
+    return deadline <= 0 || elapsed + delay < deadline;
+}
+
+int RetryPolicy::parseRetryAfter(const QByteArray &header)
+{
+    if (header.isEmpty())
+        return -1;
+
+    bool ok;
+    int seconds = header.trimmed().toInt(&ok);
+    if (ok)
+        return qMax(0, seconds) * 1000;
+
+    auto date = QDateTime::fromString(QString(header.trimmed()), Qt::RFC2822Date);
+    if (!date.isValid())
+        return -1;
+
+    return (int)qBound<qint64>(0, QDateTime::currentDateTimeUtc().msecsTo(date), 24 * 3600 * 1000);
+}
@@ -0,0 +1,34 @@
+#ifndef RETRYPOLICY_H
+#define RETRYPOLICY_H
+
+#include <QNetworkReply>
+
+// Decides whether and when a failed download is tried again.
+// Transient errors (timeouts, dropped connections, 429/500/502/503/504) of idempotent requests are
+// retried with exponential backoff and full jitter, a Retry-After header of the server takes precedence.
+// No retry is scheduled once the deadline (measured from the first attempt) would be exceeded.
+struct RetryPolicy
+{
+    RetryPolicy(int maxRetries = 3, int baseDelay = 500, int maxDelay = 15000, int deadline = 60000)
+        : maxRetries(maxRetries), baseDelay(baseDelay), maxDelay(maxDelay), deadline(deadline)
+    {
+    }
+
+    int maxRetries;
+    int baseDelay;  // ms
+    int maxDelay;   // ms
+    int deadline;   // ms, <= 0 means no deadline
+
+    // a request that isn't idempotent (POST) may already have had its effect, it is never sent again
+    bool isRetryable(bool idempotent, int httpStatus, QNetworkReply::NetworkError error) const;
+
+    // delay before the given retry (0 based), retryAfter is the server's Retry-After in ms or -1
+    int delay(int retry, int retryAfter = -1) const;
+
+    bool allowsRetry(int retry, qint64 elapsed, int delay) const;
+
+    // Retry-After is either a number of seconds or a http date, returns -1 if not present or invalid
+    static int parseRetryAfter(const QByteArray &header);
+};
+
+#endif  // RETRYPOLICY_H
@@ -30,6 +30,9 @@ public:
     const int parallelDownloadsHigh = 8;
     const int forwardPreloads = 3;
     const int backwardPreloads = 1;
+    const int burstHorizonChapters = 1;  // chapters after the current one fetched in a network burst
+    const int radioIdleOffSeconds = 30;
+    const int favoritesCheckIntervalMinutes = 30;
     const int autoSuspendIntervalMinutes = 15;
     const int globalTickIntervalSeconds = 60;
 
@@ -0,0 +1,317 @@
+#include "streamingimagedecoder.h"
+
+static void streamingJpegInitSource(j_decompress_ptr) {}
+
+static boolean streamingJpegFillInputBuffer(j_decompress_ptr)
+{
+    // suspend until more data is fed
+    return FALSE;
+}
+
+static void streamingJpegSkipInputData(j_decompress_ptr cinfo, long numBytes)
+{
+    auto src = reinterpret_cast<StreamingJpegSource *>(cinfo->src);
+
+    if (numBytes <= 0)
+        return;
+
+    if ((size_t)numBytes > src->pub.bytes_in_buffer)
+    {
+        src->bytesToSkip += numBytes - src->pub.bytes_in_buffer;
+        src->pub.next_input_byte += src->pub.bytes_in_buffer;
+        src->pub.bytes_in_buffer = 0;
+    }
+    else
+    {
+        src->pub.next_input_byte += numBytes;
+        src->pub.bytes_in_buffer -= numBytes;
+    }
+}
+
+static void streamingJpegTermSource(j_decompress_ptr) {}
+
+static void streamingJpegErrorExit(j_common_ptr cinfo)
+{
+    auto error = reinterpret_cast<StreamingJpegError *>(cinfo->err);
+    longjmp(error->jump, 1);
+}
+
+static void streamingJpegOutputMessage(j_common_ptr) {}
+
+static void streamingPngWarning(png_structp, png_const_charp) {}
+
+static void streamingPngInfo(png_structp png, png_infop)
+{
+    static_cast<StreamingImageDecoder *>(png_get_progressive_ptr(png))->pngInfoAvailable();
+}
+
+static void streamingPngRow(png_structp png, png_bytep newRow, png_uint_32 rowNum, int)
+{
+    static_cast<StreamingImageDecoder *>(png_get_progressive_ptr(png))->pngRowAvailable(newRow, rowNum);
+}
+
+static void streamingPngEnd(png_structp png, png_infop)
+{
+    static_cast<StreamingImageDecoder *>(png_get_progressive_ptr(png))->pngEnd();
+}
+
+StreamingImageDecoder::StreamingImageDecoder()
+    : format(UnknownFormat),
+      state(DetectingFormat),
+      input(),
+      image(),
+      jpegCreated(false),
+      pngPtr(nullptr),
+      pngInfoPtr(nullptr)
+{
+}
+
+StreamingImageDecoder::~StreamingImageDecoder()
+{
+    destroyDecoders();
+}
+
+void StreamingImageDecoder::destroyDecoders()
+{
+    if (jpegCreated)
+        jpeg_destroy_decompress(&jpegInfo);
+    jpegCreated = false;
+
+    if (pngPtr)
+        png_destroy_read_struct(&pngPtr, &pngInfoPtr, nullptr);
+    pngPtr = nullptr;
+    pngInfoPtr = nullptr;
+}
+
+GreyscaleImage StreamingImageDecoder::takeImage()
+{
+    return std::move(image);
+}
+
+void StreamingImageDecoder::feed(const QByteArray &data)
+{
+    if (data.isEmpty() || state == Done || state == Failed)
+        return;
+
+    if (state == DetectingFormat)
+    {
+        input.append(data);
+        detectFormat();
+        return;
+    }
+
+    if (format == JpegFormat)
+        feedJpeg(data);
+    else if (format == PngFormat && !decodePng(data))
+        state = Failed;
+}
+
+bool StreamingImageDecoder::finish()
+{
+    input.clear();
+    destroyDecoders();
+
+    if (state != Done)
+    {
+        state = Failed;
+        image = GreyscaleImage();
+    }
+
+    return state == Done;
+}
+
+void StreamingImageDecoder::detectFormat()
+{
+    if (input.size() < 3)
+        return;
+
+    auto header = input;
+    input.clear();
+
+    if (isJpeg(header))
+    {
+        format = JpegFormat;
+        state = ReadingHeader;
+        setupJpeg();
+        if (state != Failed)
+            feedJpeg(header);
+    }
+    else if (isPng(header))
+    {
+        format = PngFormat;
+        state = ReadingHeader;
+        setupPng();
+        if (!decodePng(header))
+            state = Failed;
+    }
+    else
+    {
+        state = Failed;
+    }
+}
+
+void StreamingImageDecoder::setupJpeg()
+{
+    jpegInfo.err = jpeg_std_error(&jpegError.pub);
+    jpegError.pub.error_exit = streamingJpegErrorExit;
+    jpegError.pub.output_message = streamingJpegOutputMessage;
+
+    if (setjmp(jpegError.jump))
+    {
+        state = Failed;
+        return;
+    }
+
+    jpeg_create_decompress(&jpegInfo);
+    jpegCreated = true;
+
+    jpegSource.pub.init_source = streamingJpegInitSource;
+    jpegSource.pub.fill_input_buffer = streamingJpegFillInputBuffer;
+    jpegSource.pub.skip_input_data = streamingJpegSkipInputData;
+    jpegSource.pub.resync_to_restart = jpeg_resync_to_restart;
+    jpegSource.pub.term_source = streamingJpegTermSource;
+    jpegSource.pub.next_input_byte = nullptr;
+    jpegSource.pub.bytes_in_buffer = 0;
+    jpegSource.bytesToSkip = 0;
+
+    jpegInfo.src = &jpegSource.pub;
+}
+
+void StreamingImageDecoder::feedJpeg(const QByteArray &data)
+{
+    // libjpeg backs up to the last point it can resume from when it suspends,
+    // everything before that has been consumed and can be dropped
+    int consumed = input.size() - (int)jpegSource.pub.bytes_in_buffer;
+    input.remove(0, consumed);
+
+    int skip = (int)qMin<size_t>(jpegSource.bytesToSkip, data.size());
+    jpegSource.bytesToSkip -= skip;
+    input.append(data.constData() + skip, data.size() - skip);
+
+    jpegSource.pub.next_input_byte = (const JOCTET *)input.constData();
+    jpegSource.pub.bytes_in_buffer = input.size();
+
+    if (!decodeJpeg())
+        state = Failed;
+}
+
+bool StreamingImageDecoder::decodeJpeg()
+{
+    if (setjmp(jpegError.jump))
+        return false;
+
+    if (state == ReadingHeader)
+    {
+        if (jpeg_read_header(&jpegInfo, TRUE) == JPEG_SUSPENDED)
+            return true;
+
+        // greyscale output from cmyk isn't supported by libjpeg
+        if (jpegInfo.jpeg_color_space == JCS_CMYK || jpegInfo.jpeg_color_space == JCS_YCCK)
+            return false;
+
+        jpegInfo.out_color_space = JCS_GRAYSCALE;
+        jpegInfo.dct_method = JDCT_IFAST;
+        jpegInfo.do_fancy_upsampling = FALSE;
+
+        state = StartingDecompress;
+    }
+
+    if (state == StartingDecompress)
+    {
+        if (!jpeg_start_decompress(&jpegInfo))
+            return true;
+
+        if (jpegInfo.output_components != 1)
+            return false;
+
+        image = GreyscaleImage(QSize(jpegInfo.output_width, jpegInfo.output_height));
+        state = DecodingRows;
+    }
+
+    if (state == DecodingRows)
+    {
+        JSAMPROW rows[16];
+
+        while (jpegInfo.output_scanline < jpegInfo.output_height)
+        {
+            int count = qMin<int>(16, jpegInfo.output_height - jpegInfo.output_scanline);
+            for (int i = 0; i < count; i++)
+                rows[i] = (JSAMPROW)image.buffer.data() + (jpegInfo.output_scanline + i) * image.width;
+
+            if (jpeg_read_scanlines(&jpegInfo, rows, count) == 0)
+                return true;
+        }
+
+        state = Done;
+    }
+
+    return true;
+}
+
+void StreamingImageDecoder::setupPng()
+{
+    pngPtr = png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, streamingPngWarning);
+    if (pngPtr)
+        pngInfoPtr = png_create_info_struct(pngPtr);
+
+    if (!pngPtr || !pngInfoPtr)
+    {
+        state = Failed;
+        return;
+    }
+
+    png_set_progressive_read_fn(pngPtr, this, streamingPngInfo, streamingPngRow, streamingPngEnd);
+}
+
+bool StreamingImageDecoder::decodePng(const QByteArray &data)
+{
+    if (!pngPtr)
+        return false;
+
+    if (setjmp(png_jmpbuf(pngPtr)))
+        return false;
+
+    png_process_data(pngPtr, pngInfoPtr, (png_bytep)data.constData(), data.size());
+
+    return true;
+}
+
+void StreamingImageDecoder::pngInfoAvailable()
+{
+    int colorType = png_get_color_type(pngPtr, pngInfoPtr);
+    int bitDepth = png_get_bit_depth(pngPtr, pngInfoPtr);
+
+    if (colorType == PNG_COLOR_TYPE_PALETTE)
+        png_set_palette_to_rgb(pngPtr);
+    if (colorType == PNG_COLOR_TYPE_GRAY && bitDepth < 8)
+        png_set_expand_gray_1_2_4_to_8(pngPtr);
+    if (bitDepth == 16)
+        png_set_strip_16(pngPtr);
+    if (colorType & PNG_COLOR_MASK_ALPHA)
+        png_set_strip_alpha(pngPtr);
+    if (colorType & PNG_COLOR_MASK_COLOR)
+        png_set_rgb_to_gray_fixed(pngPtr, 1, -1, -1);
+
+    png_set_interlace_handling(pngPtr);
+    png_read_update_info(pngPtr, pngInfoPtr);
+
+    int width = png_get_image_width(pngPtr, pngInfoPtr);
+    int height = png_get_image_height(pngPtr, pngInfoPtr);
+
+    if ((int)png_get_rowbytes(pngPtr, pngInfoPtr) != width)
+        png_error(pngPtr, "Unexpected row size.");
+
+    image = GreyscaleImage(QSize(width, height));
+    state = DecodingRows;
+}
+
+void StreamingImageDecoder::pngRowAvailable(png_bytep newRow, png_uint_32 rowNum)
+{
+    if (newRow && (int)rowNum < image.height)
+        png_progressive_combine_row(pngPtr, (png_bytep)image.buffer.data() + rowNum * image.width, newRow);
+}
+
+void StreamingImageDecoder::pngEnd()
+{
+    state = Done;
+}
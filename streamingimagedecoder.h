@@ -0,0 +1,89 @@
+#ifndef STREAMINGIMAGEDECODER_H
+#define STREAMINGIMAGEDECODER_H
+
+#include <png.h>
+
+#include <csetjmp>
+#include <cstdio>
+
+#include "greyscaleimage.h"
+
+extern "C"
+{
+#include <jpeglib.h>
+}
+
+struct StreamingJpegSource
+{
+    jpeg_source_mgr pub;
+    size_t bytesToSkip;
+};
+
+struct StreamingJpegError
+{
+    jpeg_error_mgr pub;
+    jmp_buf jump;
+};
+
+// Decodes jpeg and png images into a greyscale buffer while the encoded data is still arriving.
+// Rows are decoded as soon as the data for them is available, so only the last rows
+// remain to be decoded once the final chunk has been fed.
+class StreamingImageDecoder
+{
+public:
+    StreamingImageDecoder();
+    ~StreamingImageDecoder();
+
+    void feed(const QByteArray &data);
+    bool finish();
+
+    GreyscaleImage takeImage();
+
+    void pngInfoAvailable();
+    void pngRowAvailable(png_bytep newRow, png_uint_32 rowNum);
+    void pngEnd();
+
+private:
+    enum Format
+    {
+        UnknownFormat,
+        JpegFormat,
+        PngFormat
+    };
+
+    enum State
+    {
+        DetectingFormat,
+        ReadingHeader,
+        StartingDecompress,
+        DecodingRows,
+        Done,
+        Failed
+    };
+
+    Format format;
+    State state;
+
+    QByteArray input;
+    GreyscaleImage image;
+
+    jpeg_decompress_struct jpegInfo;
+    StreamingJpegSource jpegSource;
+    StreamingJpegError jpegError;
+    bool jpegCreated;
+
+    png_structp pngPtr;
+    png_infop pngInfoPtr;
+
+    void detectFormat();
+    void setupJpeg();
+    void setupPng();
+
+    void feedJpeg(const QByteArray &data);
+    bool decodeJpeg();
+    bool decodePng(const QByteArray &data);
+
+    void destroyDecoders();
+};
+
+#endif  // STREAMINGIMAGEDECODER_H
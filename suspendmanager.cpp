@@ -15,6 +15,13 @@ bool SuspendManager::suspend()
     emit suspending();
     qApp->processEvents();
 
+    networkManager->networkMetrics()->logSummary();
+    networkManager->networkMetrics()->dump(CONF.cacheDir + "networkmetrics.txt");
+    networkManager->tlsSessionCache()->serialize();
+    networkManager->redirectCache()->serialize();
+    networkManager->imageBlobStore()->serialize();
+    networkManager->adaptiveParallelism()->serialize();
+
     if (sleeping == false)
         qDebug() << QTime::currentTime().toString("hh:mm:ss") << "Going to sleep...";
 
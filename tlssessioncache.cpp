@@ -0,0 +1,115 @@
+#include "tlssessioncache.h"
+
+#include "staticsettings.h"
+
+TlsSessionCache::TlsSessionCache() : mutex(), sessions(), dirty(false)
+{
+    deserialize();
+}
+
+TlsSessionCache::~TlsSessionCache()
+{
+    serialize();
+}
+
+void TlsSessionCache::prepareConfiguration(const QString &host, QSslConfiguration &config) const
+{
+    QMutexLocker locker(&mutex);
+
+    // Qt only hands out the session tickets with persistence enabled
+    config.setSslOption(QSsl::SslOptionDisableSessionPersistence, false);
+
+    auto it = sessions.find(host);
+    if (it != sessions.end() && !it->ticket.isEmpty() && it->expires > QDateTime::currentDateTimeUtc())
+        config.setSessionTicket(it->ticket);
+}
+
+void TlsSessionCache::store(const QString &host, quint16 port, const QSslConfiguration &config)
+{
+    QMutexLocker locker(&mutex);
+
+    auto ticket = config.sessionTicket();
+    if (ticket.isEmpty())
+        return;
+
+    auto now = QDateTime::currentDateTimeUtc();
+    int lifetime = config.sessionTicketLifeTimeHint();
+
+    auto &session = sessions[host];
+    session.port = port;
+    session.ticket = ticket;
+    session.expires = now.addSecs(lifetime > 0 ? lifetime : 2 * 3600);
+    session.lastUsed = now;
+    dirty = true;
+
+    while (sessions.count() > maxEntries)
+    {
+        auto oldest = sessions.begin();
+        for (auto it = sessions.begin(); it != sessions.end(); ++it)
+            if (it->lastUsed < oldest->lastUsed)
+                oldest = it;
+        sessions.erase(oldest);
+    }
+}
+
+QStringList TlsSessionCache::recentHosts(int count) const
+{
+    QMutexLocker locker(&mutex);
+
+    QStringList hosts = sessions.keys();
+    std::sort(hosts.begin(), hosts.end(), [this](const QString &a, const QString &b) {
+        return sessions[a].lastUsed > sessions[b].lastUsed;
+    });
+
+    return hosts.mid(0, count);
+}
+
+quint16 TlsSessionCache::port(const QString &host) const
+{
+    QMutexLocker locker(&mutex);
+
+    return sessions.value(host).port;
+}
+
+void TlsSessionCache::deserialize()
+{
+    QFile file(CONF.cacheDir + "tlssessions.dat");
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    QDataStream in(&file);
+    int count = 0;
+    in >> count;
+
+    auto now = QDateTime::currentDateTimeUtc();
+    for (int i = 0; i < count && in.status() == QDataStream::Ok; i++)
+    {
+        QString host;
+        TlsSession session;
+        in >> host >> session.port >> session.ticket >> session.expires >> session.lastUsed;
+
+        if (in.status() == QDataStream::Ok && session.expires > now)
+            sessions.insert(host, session);
+    }
+    file.close();
+}
+
+void TlsSessionCache::serialize()
+{
+    QMutexLocker locker(&mutex);
+
+    if (!dirty)
+        return;
+
+    QFile file(CONF.cacheDir + "tlssessions.dat");
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+
+    QDataStream out(&file);
+    out << sessions.count();
+    for (auto it = sessions.begin(); it != sessions.end(); ++it)
+        out << it.key() << it->port << it->ticket << it->expires << it->lastUsed;
+    file.close();
+
+    dirty = false;
+}
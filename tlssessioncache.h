@@ -0,0 +1,44 @@
+#ifndef TLSSESSIONCACHE_H
+#define TLSSESSIONCACHE_H
+
+#include <QDateTime>
+#include <QMap>
+#include <QMutex>
+#include <QSslConfiguration>
+
+struct TlsSession
+{
+    quint16 port = 443;
+    QByteArray ticket;
+    QDateTime expires;  // end of the ticket lifetime announced by the server
+    QDateTime lastUsed;
+};
+
+// TLS session tickets of the recently used hosts, kept in the cache dir so connections
+// after a resume or restart are resumed instead of paying a full handshake.
+// Thread safe, the network thread stores the tickets while the suspend handler saves them.
+class TlsSessionCache
+{
+public:
+    TlsSessionCache();
+    ~TlsSessionCache();
+
+    void prepareConfiguration(const QString &host, QSslConfiguration &config) const;
+    void store(const QString &host, quint16 port, const QSslConfiguration &config);
+
+    QStringList recentHosts(int count) const;
+    quint16 port(const QString &host) const;
+
+    void serialize();
+
+private:
+    const int maxEntries = 32;
+
+    mutable QMutex mutex;
+    QMap<QString, TlsSession> sessions;
+    bool dirty;
+
+    void deserialize();
+};
+
+#endif  // TLSSESSIONCACHE_H
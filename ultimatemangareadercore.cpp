@@ -7,14 +7,17 @@ UltimateMangaReaderCore::UltimateMangaReaderCore(QObject* parent)
       currentMangaSource(nullptr),
       currentManga(),
       networkManager(new NetworkManager(this)),
-      mangaController(new MangaController(networkManager, this)),
+      radioBurstScheduler(new RadioBurstScheduler(networkManager, this)),
+      mangaController(new MangaController(networkManager, radioBurstScheduler, this)),
       favoritesManager(new FavoritesManager(activeMangaSources, this)),
       mangaChapterDownloadManager(new MangaChapterDownloadManager(networkManager, this)),
       suspendManager(new SuspendManager(networkManager, this)),
       settings(),
       timer(),
       autoSuspendTimer(),
-      currentDay(QDate::currentDate().day())
+      lastFavoritesCheck(),
+      currentDay(QDate::currentDate().day()),
+      requestedMangaUrl()
 {
     setupDirectories();
     settings.deserialize();
@@ -89,6 +92,14 @@ void UltimateMangaReaderCore::timerTick()
         favoritesManager->resetUpdatedStatus();
     }
 
+    // favorites are checked along with the next network burst instead of waking the radio up
+    if (!lastFavoritesCheck.isValid() ||
+        lastFavoritesCheck.elapsed() > CONF.favoritesCheckIntervalMinutes * 60 * 1000)
+    {
+        lastFavoritesCheck.start();
+        radioBurstScheduler->schedule("favorites", [this]() { favoritesManager->updateInfos(); });
+    }
+
     emit timeTick();
 }
 
@@ -123,11 +134,19 @@ void UltimateMangaReaderCore::setCurrentMangaSource(AbstractMangaSource* mangaSo
 
 void UltimateMangaReaderCore::setCurrentManga(const QString& mangaUrl, const QString& mangatitle)
 {
-    auto res = currentMangaSource->loadMangaInfo(mangaUrl, mangatitle);
-    if (res.isOk())
-        mangaController->setCurrentManga(res.unwrap());
-    else
-        emit error(res.unwrapErr());
+    // only the manga clicked last is opened, earlier loads still finishing are ignored
+    requestedMangaUrl = mangaUrl;
+
+    currentMangaSource
+        ->loadMangaInfoAsync(mangaUrl, mangatitle,
+                             [this, mangaUrl](QSharedPointer<MangaInfo> info) {
+                                 if (mangaUrl == requestedMangaUrl)
+                                     mangaController->setCurrentManga(info);
+                             })
+        .onFailure([this, mangaUrl](const QString& errorString) {
+            if (mangaUrl == requestedMangaUrl)
+                emit error(errorString);
+        });
 }
 
 void UltimateMangaReaderCore::setupDirectories()
@@ -179,6 +198,12 @@ void UltimateMangaReaderCore::updateMangaLists(QSharedPointer<UpdateProgressToke
 {
     for (const auto& name : progressToken->sourcesProgress.keys())
     {
+        if (progressToken->cancellation.isCancelled())
+        {
+            sortMangaLists();
+            return;
+        }
+
         if (progressToken->sourcesProgress[name] == 100)
             continue;
 
@@ -33,6 +33,7 @@ public:
     QSharedPointer<MangaInfo> currentManga;
 
     NetworkManager *networkManager;
+    RadioBurstScheduler *radioBurstScheduler;
     MangaController *mangaController;
     FavoritesManager *favoritesManager;
     MangaChapterDownloadManager *mangaChapterDownloadManager;
@@ -70,7 +71,9 @@ signals:
 private:
     QTimer timer;
     QTimer autoSuspendTimer;
+    QElapsedTimer lastFavoritesCheck;
     int currentDay;
+    QString requestedMangaUrl;
 
     void timerTick();
     void setupDirectories();
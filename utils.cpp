@@ -30,17 +30,6 @@ QString makePathLegal(QString filename)
     return ret;
 }
 
-void executeOnJobCompletion(QSharedPointer<DownloadJobBase> job, std::function<void()> lambda)
-{
-    new BindingClass(job, lambda);
-}
-
-void executeOnJobCompletion(QSharedPointer<DownloadJobBase> job,
-                            std::function<void(QSharedPointer<DownloadJobBase>)> lambda)
-{
-    new BindingClass(job, lambda);
-}
-
 PageTurnDirection conditionalReverse(PageTurnDirection dir, bool condition)
 {
     if (!condition)
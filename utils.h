@@ -39,59 +39,6 @@ inline bool awaitSignal(QObject* object, const QVector<const char*>& completionS
     return timer.isActive();
 }
 
-class BindingClass : public QObject
-{
-    Q_OBJECT
-public:
-    BindingClass(QSharedPointer<DownloadJobBase> job, std::function<void()> lambda)
-        : QObject(), job(job), lambda(lambda), lambda2(nullptr)
-    {
-        connect(job);
-    }
-
-    BindingClass(QSharedPointer<DownloadJobBase> job,
-                 std::function<void(QSharedPointer<DownloadJobBase>)> lambda)
-        : QObject(), job(job), lambda(nullptr), lambda2(lambda)
-    {
-        connect(job);
-    }
-    ~BindingClass() = default;
-
-private:
-    QSharedPointer<DownloadJobBase> job;
-    std::function<void()> lambda;
-    std::function<void(QSharedPointer<DownloadJobBase>)> lambda2;
-
-    void connect(QSharedPointer<DownloadJobBase> job)
-    {
-        if (!job->isCompleted)
-        {
-            QObject::connect(job.get(), &DownloadJobBase::completed, this, &BindingClass::action);
-            QObject::connect(job.get(), &DownloadJobBase::downloadError, this, &BindingClass::deleteLater);
-        }
-        else
-        {
-            action();
-        }
-    }
-
-    void action()
-    {
-        if (lambda)
-            lambda();
-        if (lambda2)
-            lambda2(job);
-        job.get()->disconnect();
-        job.clear();
-        deleteLater();
-    }
-};
-
-void executeOnJobCompletion(QSharedPointer<DownloadJobBase> job, std::function<void()> lambda);
-
-void executeOnJobCompletion(QSharedPointer<DownloadJobBase> job,
-                            std::function<void(QSharedPointer<DownloadJobBase>)> lambda);
-
 PageTurnDirection conditionalReverse(PageTurnDirection dir, bool condition);
 
 qint64 dirSize(const QString& path);
@@ -142,7 +142,7 @@ void UpdateMangaListsDialog::on_pushButtonOk_clicked()
 
 void UpdateMangaListsDialog::on_pushButtonCancel_clicked()
 {
-    progressToken->canceled = true;
+    progressToken->cancellation.cancel();
     close();
 }
 